@@ -0,0 +1,604 @@
+/*
+ * activities.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Tracks the activity lifecycle of each dx.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file activities.cpp
+ * Tracks the activity lifecycle of each dx.
+ */
+
+#include "activities.h"
+#include "utils.h"
+#include <ncurses.h>
+#include <stdio.h>
+#include <algorithm>
+
+/** Rows above the table: time and title, legend, column headings. */
+#define ACTIVITIES_HEADER_ROWS 3
+
+/** Weight of the newest activity in the dx and channel models. */
+#define ACTIVITIES_MODEL_WEIGHT 0.2
+
+/** Activities older than this many are dropped if never finished. */
+#define ACTIVITIES_MAX_PENDING 4
+
+/*
+ * Constructor.
+ */
+Activities::Activities() : Details()
+{
+    m_thisType = detail_activity;
+    m_recordTime = 0;
+    m_lastRequestedPage = -1;
+    m_showModel = false;
+}
+
+/*
+ * Update the lifecycle of each dx from a complete status record.
+ *
+ * @param recordTime the UTC time of the record.
+ * @param record the parsed components of the record.
+ */
+void Activities::addRecord(time_t recordTime, const vector<ComponentStatus> &record)
+{
+    m_recordTime = recordTime;
+    bool changed = false;
+
+    for(int i = 0; i < (int)record.size(); i++)
+    {
+        const ComponentStatus &status = record[i];
+        if(status.kind != ComponentStatus::kind_dx) continue;
+
+        map<string, DxTrack>::iterator it = m_dxs.find(status.name);
+        if(it == m_dxs.end())
+        {
+            //First sighting, the time it entered this state is unknown.
+            DxTrack track;
+            track.name = status.name;
+            track.state = status.state;
+            track.activityId = status.activityId;
+            track.enteredAt = recordTime;
+            track.entryKnown = false;
+            track.channel = status.channel;
+            track.slowFactor = 1.0;
+            track.modelSamples = 0;
+            track.suggestedChannel = -1;
+            m_dxs[track.name] = track;
+            changed = true;
+            continue;
+        }
+
+        DxTrack &track = it->second;
+        if(status.channel > 0 && status.channel != track.channel)
+        {
+            track.channel = status.channel;
+            changed = true;
+        }
+
+        //The file was restarted or is being replayed from the top.
+        if(recordTime < track.enteredAt)
+        {
+            track.state = status.state;
+            track.activityId = status.activityId;
+            track.enteredAt = recordTime;
+            track.entryKnown = false;
+            changed = true;
+            continue;
+        }
+
+        if(track.state == status.state && track.activityId == status.activityId)
+            continue;
+        changed = true;
+
+        if(track.entryKnown)
+        {
+            uint64_t seconds = (uint64_t)(recordTime - track.enteredAt);
+            track.histograms[track.state].record(seconds);
+            m_allDxs[track.state].record(seconds);
+
+            if(track.state == ComponentStatus::state_sig_det && track.channel > 0)
+            {
+                SigDetSample sample;
+                sample.name = track.name;
+                sample.channel = track.channel;
+                sample.seconds = (double)seconds;
+                m_pendingSigDet[track.activityId].push_back(sample);
+            }
+        }
+
+        //No activity starts before every dx has finished the last one,
+        //so a dx starting a new activity means the older ones are over.
+        if(status.activityId > track.activityId)
+        {
+            while(!m_pendingSigDet.empty() &&
+                    m_pendingSigDet.begin()->first < status.activityId)
+                finishActivity(m_pendingSigDet.begin()->first);
+        }
+
+        track.state = status.state;
+        track.activityId = status.activityId;
+        track.enteredAt = recordTime;
+        track.entryKnown = true;
+    }
+
+    while((int)m_pendingSigDet.size() > ACTIVITIES_MAX_PENDING)
+        m_pendingSigDet.erase(m_pendingSigDet.begin());
+
+    //Worked out here rather than when painting, so the model screen
+    //only reads the model.
+    if(changed) suggestChannels();
+}
+
+/*
+ * Fold the signal detection times of a finished activity into
+ * the dx and channel models.
+ *
+ * @param activityId the activity.
+ */
+void Activities::finishActivity(int activityId)
+{
+    map<int, vector<SigDetSample> >::iterator it = m_pendingSigDet.find(activityId);
+    if(it == m_pendingSigDet.end()) return;
+
+    vector<SigDetSample> samples = it->second;
+    m_pendingSigDet.erase(it);
+
+    //A single dx has nothing to be compared with.
+    if(samples.size() < 2) return;
+
+    vector<double> times;
+    for(int i = 0; i < (int)samples.size(); i++)
+        times.push_back(samples[i].seconds);
+    std::nth_element(times.begin(), times.begin() + times.size()/2, times.end());
+    double median = times[times.size()/2];
+    if(median <= 0.0) return;
+
+    //Each relative time is modelled as dx factor * channel load. Update
+    //each from the relative time with the other factored out.
+    for(int i = 0; i < (int)samples.size(); i++)
+    {
+        map<string, DxTrack>::iterator dx = m_dxs.find(samples[i].name);
+        if(dx == m_dxs.end()) continue;
+
+        double relative = samples[i].seconds / median;
+        double load = getChannelLoad(samples[i].channel);
+        double factor = dx->second.slowFactor;
+
+        m_channelLoad[samples[i].channel] = load +
+            ACTIVITIES_MODEL_WEIGHT * (relative / factor - load);
+        dx->second.slowFactor = factor +
+            ACTIVITIES_MODEL_WEIGHT * (relative / load - factor);
+        dx->second.modelSamples++;
+    }
+}
+
+/*
+ * Get the load of a channel in the model.
+ *
+ * @param channel the channel.
+ * @return the load, 1.0 is typical or unknown.
+ */
+double Activities::getChannelLoad(int channel) const
+{
+    map<int, double>::const_iterator it = m_channelLoad.find(channel);
+    if(it == m_channelLoad.end()) return 1.0;
+    return it->second;
+}
+
+/*
+ * Compare two channels, heaviest first.
+ */
+static bool heaviestFirst(const pair<double, int> &a, const pair<double, int> &b)
+{
+    if(a.first != b.first) return a.first > b.first;
+    return a.second < b.second;
+}
+
+/*
+ * Compare two dxs, fastest first.
+ */
+static bool fastestFirst(const pair<double, string> &a, const pair<double, string> &b)
+{
+    if(a.first != b.first) return a.first < b.first;
+    return a.second < b.second;
+}
+
+/*
+ * Suggest a channel for each dx from the model. The channels
+ * currently assigned are shared out again, heaviest to fastest.
+ */
+void Activities::suggestChannels()
+{
+    vector<pair<double, string> > dxs;
+    vector<pair<double, int> > channels;
+
+    for(map<string, DxTrack>::iterator it = m_dxs.begin(); it != m_dxs.end(); it++)
+    {
+        it->second.suggestedChannel = -1;
+        if(it->second.channel <= 0 ||
+                it->second.state == ComponentStatus::state_offline) continue;
+
+        dxs.push_back(make_pair(it->second.slowFactor, it->first));
+        channels.push_back(make_pair(getChannelLoad(it->second.channel),
+                    it->second.channel));
+    }
+
+    std::sort(dxs.begin(), dxs.end(), fastestFirst);
+    std::sort(channels.begin(), channels.end(), heaviestFirst);
+
+    for(int i = 0; i < (int)dxs.size(); i++)
+        m_dxs[dxs[i].second].suggestedChannel = channels[i].second;
+}
+
+/*
+ * Get the histogram of the time all dxs spent in a state.
+ *
+ * @param state the ComponentStatus::component_state_t value.
+ * @return the histogram, in seconds.
+ */
+const LatencyHistogram &Activities::getStateHistogram(int state) const
+{
+    if(state < 0 || state >= ComponentStatus::state_last)
+        state = ComponentStatus::state_unknown;
+    return m_allDxs[state];
+}
+
+/*
+ * Get how slow a dx is at signal detection in the model.
+ *
+ * @param name the dx name.
+ * @return the factor, 1.0 is typical or unknown.
+ */
+double Activities::getSlowFactor(const string &name) const
+{
+    map<string, DxTrack>::const_iterator it = m_dxs.find(name);
+    if(it == m_dxs.end()) return 1.0;
+    return it->second.slowFactor;
+}
+
+/*
+ * Get the channel suggested for a dx. The suggestions are
+ * worked out by addRecord() whenever a dx changes.
+ *
+ * @param name the dx name.
+ * @return the channel, -1 if none.
+ */
+int Activities::getSuggestedChannel(const string &name) const
+{
+    map<string, DxTrack>::const_iterator it = m_dxs.find(name);
+    if(it == m_dxs.end()) return -1;
+    return it->second.suggestedChannel;
+}
+
+/*
+ * Find the histogram of a dx for a state.
+ *
+ * @param track the dx.
+ * @param state the state.
+ * @return the histogram, NULL if the state has not been left yet.
+ */
+const LatencyHistogram *Activities::find(const DxTrack &track, int state)
+{
+    map<int, LatencyHistogram>::const_iterator it = track.histograms.find(state);
+    if(it == track.histograms.end()) return NULL;
+    return &it->second;
+}
+
+/*
+ * Compare two dxs for display, slowest signal detection first.
+ */
+bool Activities::slowestFirst(const DxTrack *a, const DxTrack *b)
+{
+    const LatencyHistogram *ha = find(*a, ComponentStatus::state_sig_det);
+    const LatencyHistogram *hb = find(*b, ComponentStatus::state_sig_det);
+    uint64_t pa = (ha == NULL) ? 0 : ha->getPercentile(99.0);
+    uint64_t pb = (hb == NULL) ? 0 : hb->getPercentile(99.0);
+
+    if(pa != pb) return pa > pb;
+    return a->name < b->name;
+}
+
+/*
+ * Compare two dxs for display, slowest in the model first.
+ */
+bool Activities::slowestModelFirst(const DxTrack *a, const DxTrack *b)
+{
+    if(a->slowFactor != b->slowFactor) return a->slowFactor > b->slowFactor;
+    return a->name < b->name;
+}
+
+/*
+ * Format p50/p99/max of a histogram into a table cell.
+ *
+ * @param histogram the histogram, NULL if there is none.
+ * @return the table cell.
+ */
+string Activities::formatCell(const LatencyHistogram *histogram)
+{
+    if(histogram == NULL || histogram->getCount() == 0) return "-";
+
+    char cell[64];
+    snprintf(cell, sizeof(cell), "%llu/%llu/%llu",
+            (unsigned long long)histogram->getPercentile(50.0),
+            (unsigned long long)histogram->getPercentile(99.0),
+            (unsigned long long)histogram->getMax());
+    return cell;
+}
+
+/*
+ * Display the information on the screen.
+ *
+ * @param pageNum the page number to display.
+ * @param pageCols the number of columns on the screen.
+ * @param pageRows the number of rows on the screen.
+ * @return true if screen has changed, else false.
+ */
+bool Activities::paint(int pageNum, int pageCols, int pageRows)
+{
+    char tempLine[256];
+    string blank(pageCols, ' ');
+
+    if(pageNum > getNumPages(pageRows)) pageNum = getNumPages(pageRows);
+    m_lastRequestedPage = pageNum;
+
+    //Draw the header
+    string headerString = "SonATA Activity Lifecycle";
+    move(0,0);
+    addstr(blank.c_str());
+    move(0,0);
+    if(m_recordTime > 0)
+    {
+        struct tm t;
+        gmtime_r(&m_recordTime, &t);
+        strftime(tempLine, sizeof(tempLine), "%H:%M:%S UTC", &t);
+        addstr(tempLine);
+    }
+    Utils::drawColorText(0, pageCols/2 - headerString.size()/2, 3, headerString);
+
+    if(m_showModel)
+        paintModel(pageNum, pageCols, pageRows);
+    else
+        paintTimes(pageNum, pageCols, pageRows);
+
+    //Park the cursor in the lower right corner
+    move(pageRows-1, pageCols-1);
+
+    return true;
+}
+
+/*
+ * Draw one page of the time in state table.
+ */
+void Activities::paintTimes(int pageNum, int pageCols, int pageRows)
+{
+    char tempLine[256];
+    string blank(pageCols, ' ');
+    string line;
+
+    move(1,0);
+    line = "Seconds in state, p50/p99/max. Slowest signal detection first. m=Model";
+    line.resize(pageCols, ' ');
+    addstr(line.c_str());
+
+    snprintf(tempLine, sizeof(tempLine), "%-7s %-15s %5s  %-15s  %-15s  %-15s",
+            "Dx", "State", "For", "Base Accum", "Data Coll", "Sig Det");
+    line = tempLine;
+    line.resize(pageCols, ' ');
+    Utils::drawColorText(2, 0, 2, line);
+
+    //The first table row is the total over all dxs.
+    vector<const DxTrack *> rows;
+    DxTrack all;
+    all.name = "all";
+    all.state = ComponentStatus::state_unknown;
+    all.enteredAt = m_recordTime;
+    all.entryKnown = false;
+    all.histograms[ComponentStatus::state_base_accum] =
+        m_allDxs[ComponentStatus::state_base_accum];
+    all.histograms[ComponentStatus::state_data_coll] =
+        m_allDxs[ComponentStatus::state_data_coll];
+    all.histograms[ComponentStatus::state_sig_det] =
+        m_allDxs[ComponentStatus::state_sig_det];
+
+    vector<const DxTrack *> dxs;
+    for(map<string, DxTrack>::const_iterator it = m_dxs.begin();
+            it != m_dxs.end(); it++)
+        dxs.push_back(&it->second);
+    std::sort(dxs.begin(), dxs.end(), Activities::slowestFirst);
+
+    rows.push_back(&all);
+    rows.insert(rows.end(), dxs.begin(), dxs.end());
+
+    int realRows = pageRows - ACTIVITIES_HEADER_ROWS;
+    int startIndex = (pageNum-1) * realRows;
+
+    for(int i = 0; i < realRows; i++)
+    {
+        int index = startIndex + i;
+        int row = ACTIVITIES_HEADER_ROWS + i;
+
+        if(index >= (int)rows.size())
+        {
+            move(row, 0);
+            addstr(blank.c_str());
+            continue;
+        }
+
+        const DxTrack *track = rows[index];
+        string state = "";
+        string inState = "";
+        if(track != &all)
+        {
+            state = ComponentStatus::stateName(track->state);
+            inState = Utils::itos((int)(m_recordTime - track->enteredAt));
+        }
+
+        snprintf(tempLine, sizeof(tempLine), "%-7s %-15s %5s  %-15s  %-15s  %-15s",
+                track->name.c_str(), state.c_str(), inState.c_str(),
+                formatCell(find(*track, ComponentStatus::state_base_accum)).c_str(),
+                formatCell(find(*track, ComponentStatus::state_data_coll)).c_str(),
+                formatCell(find(*track, ComponentStatus::state_sig_det)).c_str());
+        line = tempLine;
+        line.resize(pageCols, ' ');
+
+        if(track == &all)
+            Utils::drawColorText(row, 0, 5, line);
+        else
+        {
+            move(row, 0);
+            addstr(line.c_str());
+        }
+    }
+}
+
+/*
+ * Draw one page of the dx model.
+ */
+void Activities::paintModel(int pageNum, int pageCols, int pageRows)
+{
+    char tempLine[256];
+    string blank(pageCols, ' ');
+    string line;
+
+    move(1,0);
+    line = "Signal detection model, 1.00=typical. Slowest dx first. m=Times";
+    line.resize(pageCols, ' ');
+    addstr(line.c_str());
+
+    snprintf(tempLine, sizeof(tempLine), "%-7s %5s %6s %5s %6s  %7s %9s",
+            "Dx", "Acts", "Slow", "Chan", "Load", "Suggest", "Max Cands");
+    line = tempLine;
+    line.resize(pageCols, ' ');
+    Utils::drawColorText(2, 0, 2, line);
+
+    vector<const DxTrack *> rows;
+    for(map<string, DxTrack>::const_iterator it = m_dxs.begin();
+            it != m_dxs.end(); it++)
+        rows.push_back(&it->second);
+    std::sort(rows.begin(), rows.end(), Activities::slowestModelFirst);
+
+    int realRows = pageRows - ACTIVITIES_HEADER_ROWS;
+    int startIndex = (pageNum-1) * realRows;
+
+    for(int i = 0; i < realRows; i++)
+    {
+        int index = startIndex + i;
+        int row = ACTIVITIES_HEADER_ROWS + i;
+
+        if(index >= (int)rows.size())
+        {
+            move(row, 0);
+            addstr(blank.c_str());
+            continue;
+        }
+
+        const DxTrack *track = rows[index];
+
+        //The candidate limit is scaled down in proportion for a dx that
+        //is slower than typical.
+        int candPercent = 100;
+        if(track->slowFactor > 1.0) candPercent = (int)(100.0 / track->slowFactor);
+
+        string suggest = "-";
+        if(track->suggestedChannel > 0)
+        {
+            suggest = Utils::itos(track->suggestedChannel);
+            if(track->suggestedChannel != track->channel) suggest += "*";
+        }
+
+        snprintf(tempLine, sizeof(tempLine), "%-7s %5d %6.2f %5d %6.2f  %7s %8d%%",
+                track->name.c_str(), track->modelSamples, track->slowFactor,
+                track->channel, getChannelLoad(track->channel),
+                suggest.c_str(), candPercent);
+        line = tempLine;
+        line.resize(pageCols, ' ');
+
+        //Highlight the stragglers.
+        if(track->modelSamples > 0 && track->slowFactor > 1.2)
+            Utils::drawColorText(row, 0, 1, line);
+        else
+        {
+            move(row, 0);
+            addstr(line.c_str());
+        }
+    }
+}
+
+/*
+ * Handle a key press. 'm' switches between the time in state
+ * table and the dx model.
+ *
+ * @param ch the key, as returned by getch().
+ * @return true if the screen should be repainted, else false.
+ */
+bool Activities::processKey(int ch)
+{
+    if(ch != 'm') return false;
+
+    m_showModel = !m_showModel;
+    return true;
+}
+
+/*
+ * Get the number of pages required to display all the information.
+ *
+ * @param pageRows the number of rows available on the screen.
+ * @return the number of pages required to display all the
+ * information.
+ */
+int Activities::getNumPages(int pageRows)
+{
+    int realRows = pageRows - ACTIVITIES_HEADER_ROWS;
+    if(realRows < 1) return 1;
+
+    //The time table has one extra row for the total over all dxs.
+    int rows = (int)m_dxs.size();
+    if(!m_showModel) rows++;
+    return (rows - 1) / realRows + 1;
+}
+
+/*
+ * Get the type of this object inherited from the Details class.
+ *
+ * @return the type as a detail_t enum value.
+ */
+int Activities::getType()
+{
+    return m_thisType;
+}
+
+/*
+ * Get the current page number displayed.
+ *
+ * @return the current page number displayed.
+ */
+int Activities::getCurrentPageNumber()
+{
+    if(m_lastRequestedPage <= 0) return 1;
+    return m_lastRequestedPage;
+}
@@ -0,0 +1,269 @@
+/*
+ * activities.h
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Tracks the activity lifecycle of each dx.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file activities.h
+ * Tracks the activity lifecycle of each dx.
+ */
+
+#ifndef ACTIVITIES_H
+#define ACTIVITIES_H
+
+#include "details.h"
+#include "componentstatus.h"
+#include "latencyhistogram.h"
+#include <map>
+
+using namespace std;
+
+/**
+ * Tracks the activity lifecycle of each dx and displays how long the
+ * dxs spend in each state.
+ *
+ * Every complete status record is passed to addRecord(). When a dx
+ * changes state the time it spent in the old state is recorded in a
+ * histogram for that dx and state, and in one for all dxs. The times
+ * are taken from the record timestamps rather than the wall clock so
+ * that replaying a saved "sse-system-status.txt" gives the same
+ * result as watching it live.
+ *
+ * Since every activity waits for the slowest dx to finish signal
+ * detection, a rolling model is also kept of how slow each dx is and
+ * how heavy each channel (i.e. band, with its RFI) is to search. When
+ * an activity is over, each dx's signal detection time is divided by
+ * the median over all its dxs, and the result is split between a
+ * factor for the dx and a load for the channel it had, each an
+ * exponentially weighted moving average. From this a channel is
+ * suggested for each dx whenever a record changes a dx, putting the
+ * heaviest channels on the fastest dxs, and the model screen shows
+ * these with a scale for maxNumberOfCandidates on the slow dxs.
+ * These are only suggestions for the operator, the display has no way
+ * to configure the dxs.
+ *
+ * Inherits from the Details class.
+ */
+class Activities: public Details
+{
+    public:
+
+        /** Constructor. */
+        Activities();
+
+        /**
+         * Update the lifecycle of each dx from a complete status record.
+         *
+         * @param recordTime the UTC time of the record.
+         * @param record the parsed components of the record.
+         */
+        void addRecord(time_t recordTime, const vector<ComponentStatus> &record);
+
+        /**
+         * Get the histogram of the time all dxs spent in a state.
+         *
+         * @param state the ComponentStatus::component_state_t value.
+         * @return the histogram, in seconds.
+         */
+        const LatencyHistogram &getStateHistogram(int state) const;
+
+        /**
+         * Get how slow a dx is at signal detection in the model.
+         *
+         * @param name the dx name.
+         * @return the factor, 1.0 is typical or unknown.
+         */
+        double getSlowFactor(const string &name) const;
+
+        /**
+         * Get the load of a channel in the model.
+         *
+         * @param channel the channel.
+         * @return the load, 1.0 is typical or unknown.
+         */
+        double getChannelLoad(int channel) const;
+
+        /**
+         * Get the channel suggested for a dx. The suggestions are
+         * worked out by addRecord() whenever a dx changes.
+         *
+         * @param name the dx name.
+         * @return the channel, -1 if none.
+         */
+        int getSuggestedChannel(const string &name) const;
+
+        /**
+         * Get the number of pages required to display all the information.
+         *
+         * @param pageRows the number of rows available on the screen.
+         * @return the number of pages required to display all the
+         * information.
+         */
+        int getNumPages(int pageRows);
+
+        /**
+         * Get the type of this object inherited from the Details class.
+         *
+         * @return the type as a detail_t enum value.
+         */
+        int getType();
+
+        /**
+         * Get the current page number displayed.
+         *
+         * @return the current page number displayed.
+         */
+        int getCurrentPageNumber();
+
+        /**
+         * Display the information on the screen.
+         *
+         * @param pageNum the page number to display.
+         * @param pageCols the number of columns on the screen.
+         * @param pageRows the number of rows on the screen.
+         * @return true if screen has changed, else false.
+         */
+        bool paint(int pageNum, int pageCols, int pageRows);
+
+        /**
+         * Handle a key press. 'm' switches between the time in state
+         * table and the dx model.
+         *
+         * @param ch the key, as returned by getch().
+         * @return true if the screen should be repainted, else false.
+         */
+        bool processKey(int ch);
+
+    private:
+
+        /**
+         * The lifecycle of one dx.
+         */
+        struct DxTrack
+        {
+            /** The dx name. */
+            string name;
+            /** The current state. */
+            int state;
+            /** The current activity id. */
+            int activityId;
+            /** When the current state was entered. */
+            time_t enteredAt;
+            /** False until the dx has been seen entering a state. */
+            bool entryKnown;
+            /** Time spent in each state, in seconds. */
+            map<int, LatencyHistogram> histograms;
+            /** The channel the dx is currently assigned. */
+            int channel;
+            /** How slow the dx is at signal detection, 1.0 is typical. */
+            double slowFactor;
+            /** The number of activities in the slowness model. */
+            int modelSamples;
+            /** The channel suggested for the dx, -1 if none. */
+            int suggestedChannel;
+        };
+
+        /**
+         * One dx's signal detection in an activity that may still be
+         * running on other dxs.
+         */
+        struct SigDetSample
+        {
+            /** The dx name. */
+            string name;
+            /** The channel the dx had. */
+            int channel;
+            /** The time it spent in signal detection, in seconds. */
+            double seconds;
+        };
+
+        /**
+         * Fold the signal detection times of a finished activity into
+         * the dx and channel models.
+         *
+         * @param activityId the activity.
+         */
+        void finishActivity(int activityId);
+
+        /**
+         * Suggest a channel for each dx from the model. The channels
+         * currently assigned are shared out again, heaviest to fastest.
+         */
+        void suggestChannels();
+
+        /**
+         * Draw one page of the time in state table.
+         */
+        void paintTimes(int pageNum, int pageCols, int pageRows);
+
+        /**
+         * Draw one page of the dx model.
+         */
+        void paintModel(int pageNum, int pageCols, int pageRows);
+
+        /**
+         * Compare two dxs for display, slowest signal detection first.
+         */
+        static bool slowestFirst(const DxTrack *a, const DxTrack *b);
+
+        /**
+         * Compare two dxs for display, slowest in the model first.
+         */
+        static bool slowestModelFirst(const DxTrack *a, const DxTrack *b);
+
+        /**
+         * Format p50/p99/max of a histogram into a table cell.
+         *
+         * @param histogram the histogram, NULL if there is none.
+         * @return the table cell.
+         */
+        static string formatCell(const LatencyHistogram *histogram);
+
+        /**
+         * Find the histogram of a dx for a state.
+         *
+         * @param track the dx.
+         * @param state the state.
+         * @return the histogram, NULL if the state has not been left yet.
+         */
+        static const LatencyHistogram *find(const DxTrack &track, int state);
+
+        map<string, DxTrack> m_dxs;
+        LatencyHistogram m_allDxs[ComponentStatus::state_last];
+        time_t m_recordTime;
+        int m_lastRequestedPage;
+        bool m_showModel;
+
+        /** Signal detection times by activity, until the activity ends. */
+        map<int, vector<SigDetSample> > m_pendingSigDet;
+
+        /** How heavy each channel is to search, 1.0 is typical. */
+        map<int, double> m_channelLoad;
+};
+
+#endif //ACTIVITIES_H
+
@@ -0,0 +1,169 @@
+/*
+ * activitiescheck.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Checks the dx model of the activity screen.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file activitiescheck.cpp
+ * Checks the dx model of the activity screen.
+ *
+ * Build and run with "make check". A status file is recorded for
+ * three dxs that take turns on three channels, where dx1001 is fast,
+ * dx1003 is slow and channel 3 is heavy. The file is read back line
+ * by line through Components into Activities, as the display reads
+ * "sse-system-status.txt", and the slow factors, channel loads and
+ * suggested channels are checked. Prints each check that fails and
+ * exits with 1 if any did.
+ */
+
+#include "components.h"
+#include "activities.h"
+#include <stdio.h>
+#include <time.h>
+
+/** The number of dxs in the recording. */
+#define CHECK_DXS 3
+
+/** The number of activities in the recording. */
+#define CHECK_ACTIVITIES 40
+
+/** The signal detection time of a typical dx on a typical channel. */
+#define CHECK_SIG_DET_SECONDS 100.0
+
+/** How slow each dx is, dx1001 first. */
+static const double dxFactor[CHECK_DXS] = { 0.8, 1.0, 2.0 };
+
+/** How heavy each channel is, channel 1 first. */
+static const double channelLoad[CHECK_DXS] = { 0.8, 1.0, 1.5 };
+
+/** The number of checks that failed. */
+static int failures = 0;
+
+/** Report a check that failed. */
+static void check(bool ok, const char *what)
+{
+    if(ok) return;
+    printf("FAILED: %s\n", what);
+    failures++;
+}
+
+/** Write one status record, each dx in signal detection until its time. */
+static void writeRecord(FILE *file, time_t recordTime, int activityId,
+        time_t start, const int *seconds)
+{
+    char timeText[32];
+    struct tm t;
+
+    gmtime_r(&recordTime, &t);
+    strftime(timeText, sizeof(timeText), "%Y-%m-%d %H:%M:%S UTC", &t);
+
+    fprintf(file, "NSS %s\n", timeText);
+    for(int dx = 0; dx < CHECK_DXS; dx++)
+    {
+        int channel = (dx + activityId) % CHECK_DXS + 1;
+        const char *state = "Sig Det";
+        if(recordTime >= start + seconds[dx]) state = "Sig Det Complete";
+        fprintf(file, "dx100%d (beam1) %s  Act %d: %s  Sky: 8424.914 MHz Chan: %d\n",
+                dx + 1, timeText, activityId, state, channel);
+    }
+    fprintf(file, "====================================================\n");
+}
+
+/** Record the activities, a record at the start and as each dx finishes. */
+static void recordStatus(FILE *file)
+{
+    time_t start = 1281140374;
+
+    for(int activityId = 1; activityId <= CHECK_ACTIVITIES; activityId++)
+    {
+        int seconds[CHECK_DXS];
+        int longest = 0;
+        for(int dx = 0; dx < CHECK_DXS; dx++)
+        {
+            int channel = (dx + activityId) % CHECK_DXS + 1;
+            seconds[dx] = (int)(CHECK_SIG_DET_SECONDS * dxFactor[dx] *
+                    channelLoad[channel - 1]);
+            if(seconds[dx] > longest) longest = seconds[dx];
+        }
+
+        writeRecord(file, start, activityId, start, seconds);
+        for(int dx = 0; dx < CHECK_DXS; dx++)
+            writeRecord(file, start + seconds[dx], activityId, start, seconds);
+
+        start += longest + 10;
+    }
+}
+
+int main()
+{
+    FILE *file = tmpfile();
+    if(file == NULL)
+    {
+        printf("FAILED: could not create the status file\n");
+        return 1;
+    }
+    recordStatus(file);
+    rewind(file);
+
+    Components components;
+    Activities activities;
+    char line[256];
+    int records = 0;
+    while(fgets(line, sizeof(line), file) != NULL)
+    {
+        if(!components.addWithFilter(line)) continue;
+        activities.addRecord(components.getRecordTime(), components.getRecord());
+        records++;
+    }
+    fclose(file);
+
+    check(records == CHECK_ACTIVITIES * (CHECK_DXS + 1), "every record is read");
+
+    double fast = activities.getSlowFactor("dx1001");
+    double typical = activities.getSlowFactor("dx1002");
+    double slow = activities.getSlowFactor("dx1003");
+    check(fast < typical && typical < slow, "the dxs are ordered by slowness");
+    check(slow > 1.2, "dx1003 is slow enough to be highlighted");
+    check(fast < 1.0, "dx1001 is faster than typical");
+
+    check(activities.getChannelLoad(3) > activities.getChannelLoad(2) &&
+            activities.getChannelLoad(2) > activities.getChannelLoad(1),
+            "the channels are ordered by load");
+    check(activities.getChannelLoad(99) == 1.0, "an unknown channel is typical");
+
+    check(activities.getSuggestedChannel("dx1001") == 3,
+            "the heaviest channel is suggested for the fastest dx");
+    check(activities.getSuggestedChannel("dx1002") == 2,
+            "the middle channel is suggested for the typical dx");
+    check(activities.getSuggestedChannel("dx1003") == 1,
+            "the lightest channel is suggested for the slowest dx");
+    check(activities.getSuggestedChannel("dx9999") == -1,
+            "no channel is suggested for an unknown dx");
+
+    if(failures == 0) printf("All activity model checks passed.\n");
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+/*
+ * componentregistry.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Gives each component name a small dense id.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file componentregistry.cpp
+ * Gives each component name a small dense id.
+ */
+
+#include "componentregistry.h"
+#include <string.h>
+
+/** The starting number of hash table slots, a power of 2. */
+#define COMPONENT_REGISTRY_SLOTS 256
+
+/*
+ * Constructor.
+ */
+ComponentRegistry::ComponentRegistry()
+{
+    m_slots.resize(COMPONENT_REGISTRY_SLOTS, -1);
+}
+
+/*
+ * Hash a name, FNV-1a.
+ */
+uint32_t ComponentRegistry::hash(const char *key, size_t length)
+{
+    uint32_t keyHash = 2166136261U;
+    for(size_t i = 0; i < length; i++)
+    {
+        keyHash ^= (uint8_t)key[i];
+        keyHash *= 16777619U;
+    }
+    return keyHash;
+}
+
+/*
+ * Find the id of a name.
+ *
+ * @param key the start of the name, need not be '\\0' terminated.
+ * @param length the length of the name.
+ * @return the id, -1 if the name has not been added.
+ */
+int ComponentRegistry::find(const char *key, size_t length) const
+{
+    size_t mask = m_slots.size() - 1;
+    for(size_t slot = hash(key, length) & mask; ; slot = (slot + 1) & mask)
+    {
+        int id = m_slots[slot];
+        if(id < 0) return -1;
+
+        const string &name = m_names[id];
+        if(name.size() == length && memcmp(name.data(), key, length) == 0) return id;
+    }
+}
+
+/*
+ * Get the id of a name, adding it if it is new.
+ *
+ * @param key the start of the name, need not be '\\0' terminated.
+ * @param length the length of the name.
+ * @return the id, -1 if the registry is full.
+ */
+int ComponentRegistry::intern(const char *key, size_t length)
+{
+    int id = find(key, length);
+    if(id >= 0) return id;
+
+    return add(key, length, hash(key, length));
+}
+
+/*
+ * Get the id of a name, adding it if it is new.
+ *
+ * @param name the name.
+ * @return the id, -1 if the registry is full.
+ */
+int ComponentRegistry::intern(const string &name)
+{
+    return intern(name.data(), name.size());
+}
+
+/*
+ * Get the id of a component name, adding it if it is new and
+ * it starts with the prefix of a known kind of component. Other
+ * words, such as "NSS", are not added.
+ *
+ * @param key the start of the name, need not be '\\0' terminated.
+ * @param length the length of the name.
+ * @return the id, -1 if the name is not a component or the
+ * registry is full.
+ */
+int ComponentRegistry::lookupComponent(const char *key, size_t length)
+{
+    int id = find(key, length);
+    if(id >= 0) return id;
+
+    //A new name, only now are the kind prefixes compared.
+    if(ComponentStatus::parseKind(string(key, length)) == ComponentStatus::kind_unknown)
+        return -1;
+
+    return add(key, length, hash(key, length));
+}
+
+/*
+ * Add a name that is not in the table.
+ *
+ * @return the id, -1 if the registry is full.
+ */
+int ComponentRegistry::add(const char *key, size_t length, uint32_t keyHash)
+{
+    if((int)m_names.size() >= COMPONENT_REGISTRY_MAX) return -1;
+
+    int id = (int)m_names.size();
+    m_names.push_back(string(key, length));
+    m_kinds.push_back((uint8_t)ComponentStatus::parseKind(m_names.back()));
+
+    //Keep the table at most half full so most finds take one probe.
+    if(m_names.size() * 2 > m_slots.size())
+    {
+        grow();
+        return id;
+    }
+
+    size_t mask = m_slots.size() - 1;
+    size_t slot = keyHash & mask;
+    while(m_slots[slot] >= 0) slot = (slot + 1) & mask;
+    m_slots[slot] = id;
+
+    return id;
+}
+
+/*
+ * Make the table bigger and put the ids back in.
+ */
+void ComponentRegistry::grow()
+{
+    m_slots.assign(m_slots.size() * 2, -1);
+
+    size_t mask = m_slots.size() - 1;
+    for(int id = 0; id < (int)m_names.size(); id++)
+    {
+        size_t slot = hash(m_names[id].data(), m_names[id].size()) & mask;
+        while(m_slots[slot] >= 0) slot = (slot + 1) & mask;
+        m_slots[slot] = id;
+    }
+}
+
+/*
+ * Get the kind of component of an id.
+ *
+ * @param id the id.
+ * @return the ComponentStatus::component_kind_t value.
+ */
+int ComponentRegistry::getKind(int id) const
+{
+    if(id < 0 || id >= (int)m_kinds.size()) return ComponentStatus::kind_unknown;
+    return m_kinds[id];
+}
+
+/*
+ * Get the name of an id.
+ *
+ * @param id the id.
+ * @return the name, "" if the id is unknown.
+ */
+const string &ComponentRegistry::getName(int id) const
+{
+    static const string unknown;
+    if(id < 0 || id >= (int)m_names.size()) return unknown;
+    return m_names[id];
+}
+
+/*
+ * Check if the registry holds COMPONENT_REGISTRY_MAX names.
+ *
+ * @return true if no more names can be added.
+ */
+bool ComponentRegistry::isFull() const
+{
+    return (int)m_names.size() >= COMPONENT_REGISTRY_MAX;
+}
+
+/*
+ * Get the number of ids.
+ *
+ * @return the number of ids.
+ */
+int ComponentRegistry::size() const
+{
+    return (int)m_names.size();
+}
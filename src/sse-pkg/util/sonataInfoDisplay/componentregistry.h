@@ -0,0 +1,165 @@
+/*
+ * componentregistry.h
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Gives each component name a small dense id.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file componentregistry.h
+ * Gives each component name a small dense id.
+ */
+
+#ifndef COMPONENTREGISTRY_H
+#define COMPONENTREGISTRY_H
+
+#include "componentstatus.h"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/** The most component names a registry will hold. */
+#define COMPONENT_REGISTRY_MAX 4096
+
+/**
+ * Gives each component name (the first word of a status line, such as
+ * "dx1000") a small id, from 0 up in the order the names are first
+ * seen, and remembers its ComponentStatus::component_kind_t.
+ *
+ * The names are kept in an open addressing hash table, so the id and
+ * kind of a line are found with one hash of its first word and usually
+ * one probe, where matching every kind prefix in turn would take a
+ * string comparison each. The ids are dense, so the state kept for each
+ * component can be a plain vector indexed by id.
+ *
+ * Names are compared whole, so names longer than ComponentStatus
+ * keeps still get ids of their own. Once COMPONENT_REGISTRY_MAX names
+ * are held no more are added, and the caller must find the kind of a
+ * new name itself.
+ */
+class ComponentRegistry
+{
+    public:
+
+        /** Constructor. */
+        ComponentRegistry();
+
+        /**
+         * Find the id of a name.
+         *
+         * @param key the start of the name, need not be '\\0' terminated.
+         * @param length the length of the name.
+         * @return the id, -1 if the name has not been added.
+         */
+        int find(const char *key, size_t length) const;
+
+        /**
+         * Get the id of a name, adding it if it is new.
+         *
+         * @param key the start of the name, need not be '\\0' terminated.
+         * @param length the length of the name.
+         * @return the id, -1 if the registry is full.
+         */
+        int intern(const char *key, size_t length);
+
+        /**
+         * Get the id of a name, adding it if it is new.
+         *
+         * @param name the name.
+         * @return the id, -1 if the registry is full.
+         */
+        int intern(const string &name);
+
+        /**
+         * Get the id of a component name, adding it if it is new and
+         * it starts with the prefix of a known kind of component. Other
+         * words, such as "NSS", are not added.
+         *
+         * @param key the start of the name, need not be '\\0' terminated.
+         * @param length the length of the name.
+         * @return the id, -1 if the name is not a component or the
+         * registry is full.
+         */
+        int lookupComponent(const char *key, size_t length);
+
+        /**
+         * Get the kind of component of an id.
+         *
+         * @param id the id.
+         * @return the ComponentStatus::component_kind_t value.
+         */
+        int getKind(int id) const;
+
+        /**
+         * Get the name of an id.
+         *
+         * @param id the id.
+         * @return the name, "" if the id is unknown.
+         */
+        const string &getName(int id) const;
+
+        /**
+         * Check if the registry holds COMPONENT_REGISTRY_MAX names.
+         *
+         * @return true if no more names can be added.
+         */
+        bool isFull() const;
+
+        /**
+         * Get the number of ids.
+         *
+         * @return the number of ids.
+         */
+        int size() const;
+
+    private:
+
+        /**
+         * Hash a name, FNV-1a.
+         */
+        static uint32_t hash(const char *key, size_t length);
+
+        /**
+         * Add a name that is not in the table.
+         *
+         * @return the id, -1 if the registry is full.
+         */
+        int add(const char *key, size_t length, uint32_t keyHash);
+
+        /**
+         * Make the table bigger and put the ids back in.
+         */
+        void grow();
+
+        /** The names and kinds by id. */
+        vector<string> m_names;
+        vector<uint8_t> m_kinds;
+
+        /** The hash table, a power of 2 in size, -1 for an empty slot. */
+        vector<int> m_slots;
+};
+
+#endif //COMPONENTREGISTRY_H
@@ -34,10 +34,12 @@
 
 #include "components.h"
 #include "utils.h"
+#include "diagnostics.h"
 #include <ncurses.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 /*
  * Constructor.
@@ -62,6 +64,10 @@ Components::Components() : Details()
 
   m_screenBuffer.clear();
 
+  m_record.clear();
+  m_recordTime = 0;
+  m_recordText.clear();
+
   m_chanTotalCount = 0;
   m_chanRunningCount = 0;
   m_dxOfflineCount = 0;
@@ -70,6 +76,7 @@ Components::Components() : Details()
   m_dxDataCollCount = 0;
   m_dxSigDetCount = 0;
   m_dxTotalCount = 0;
+  m_unparsedCount = 0;
 
   m_channelizerSummary = "";
 
@@ -79,6 +86,7 @@ Components::Components() : Details()
   m_lastFreqRangeStringLen = 0;
 
   m_detailsCount = 0;
+  m_nameWidth = 6;
 }
 
 /*
@@ -94,170 +102,277 @@ Components::Components() : Details()
  */
 bool Components::addWithFilter(string line)
 {
-    if(Utils::startsWith("chan", line))
+    uint64_t start = Diagnostics::now();
+    Diagnostics::count(Diagnostics::counter_lines_parsed);
+
+    //The lines are read with fgets(), so most end in a newline.
+    size_t length = line.find_last_not_of("\r\n");
+    line.erase((length == string::npos) ? 0 : length + 1);
+
+    //Identify the component from the first word of the line, then read
+    //its fields in one pass with the grammar for its kind.
+    size_t keyLength = line.find_first_of(" \t");
+    if(keyLength == string::npos) keyLength = line.size();
+    int id = m_registry.lookupComponent(line.data(), keyLength);
+    int kind = m_registry.getKind(id);
+    if(id < 0 && m_registry.isFull())
     {
-        size_t pos = line.find("UTC");
-        if(pos != string::npos)
-        {
-            line = line.replace(pos, (size_t)4, "");
-            pos = line.find("UTC", pos+1);
-        }
-
-        m_chanTotalCount++;
-
-        pos = line.find("Run");
-        if(pos != string::npos)
-        {
-            m_chanRunningCount++;
-        }
-
-        add((line));
+        //No room for a new name, so find its kind the slow way.
+        kind = ComponentStatus::parseKind(line.substr(0, keyLength));
     }
-    else if(Utils::startsWith("dx", line))
-    {
-
-        string newLine = line;
 
-        size_t pos = newLine.find("UTC");
-        if(pos != string::npos && pos < newLine.size() - 5)
-        {
-            newLine = newLine.replace(pos, (size_t)4, "");
-        }
+    StatusLine fields;
+    bool matched = m_grammar.match(kind, line.data(), line.size(), fields);
 
-        m_dxTotalCount++;
-
-        pos = line.find("ffline");
-        if(pos != string::npos)
-        {
-            m_dxOfflineCount++;
-        }
-
-        pos = line.find("No Activities");
-        if(pos != string::npos)
-        {
-            m_dxIdleCount++;
-        }
-
-        pos = line.find("Base Accum");
-        if(pos != string::npos)
-        {
-            m_dxBaseAccumCount++;
-        }
-
-        pos = line.find("Data Coll");
-        if(pos != string::npos)
-        {
-            m_dxDataCollCount++;
-        }
-
-        pos = line.find("Sig Det");
-        if(pos != string::npos)
-        {
-            m_dxSigDetCount++;
-        }
+    if(kind != ComponentStatus::kind_unknown)
+    {
+        m_recordText.push_back(line);
+        ComponentStatus &status = recordComponent(line, id, kind, matched ? &fields : NULL);
 
-        //Attempt to read the activity number, if there is one
         //dx1001 (beam1) 2010-08-07 00:19:34 UTC  Act 2735: Init  Sky: 8424.914 MHz Chan: 13
-        pos = newLine.find("Act ");
-        if(pos != string::npos)
+        if(status.activityId >= 0)
         {
-            size_t pos2 = newLine.find(": ");
-            if(pos2 != string::npos)
-                m_activity = newLine.substr(pos + 4, (pos2-pos-4)); 
+            m_activity.clear();
+            Utils::appendInt(m_activity, status.activityId);
         }
 
-        //Determine the min and max freq
-        int channel = -1;
-        pos = newLine.find("Chan:");
-        if(pos != string::npos) channel = Utils::stof(newLine.substr(pos+5));
-        if(channel > 0)
-        {
-            pos = newLine.find("Sky:");
-            if(pos != string::npos)
-            {
-                size_t pos2 = newLine.find("MHz");
-                if(pos2 != string::npos)
-                {
-                    float freq = Utils::stof(newLine.substr((pos+4), (pos2-pos-4)));
-                    if(freq < m_minDxFreqMHz) m_minDxFreqMHz = freq;
-                    if(freq > m_maxDxFreqMHz) m_maxDxFreqMHz = freq;
-                }
-            }
-        }
+        countComponent(status);
+
+        //The channelizer and dx lines are shown without "UTC".
+        if((kind == ComponentStatus::kind_chan || kind == ComponentStatus::kind_dx) &&
+                fields.utcOffset != string::npos && fields.utcOffset + 4 < line.size())
+            line.erase(fields.utcOffset, 4);
 
-        add((newLine));
+        add(line);
     }
-    else if(Utils::startsWith("arch", line))
+    else if(matched)
     {
-        add((line));
+        //NSS  2010-08-07 00:19:34 UTC  Status
+        startRecord(fields.timestamp);
+        m_recordText.push_back(line);
+        Diagnostics::traceSource(fields.timestamp);
+        m_time.assign(fields.time, 8);
+        m_time.append(" UTC");
+        m_date.assign(fields.date, 10);
     }
-    else if(Utils::startsWith("tscope", line))
+    else if(Utils::startsWith("NSS", line))
     {
-        add(line);
+        //A header the grammar does not know, the format may have changed.
+        time_t recordTime = ComponentStatus::parseTime(line);
+        startRecord(recordTime);
+        m_recordText.push_back(line);
+        m_unparsedCount++;
+        Diagnostics::traceSource(recordTime);
+        size_t pos = line.find("UTC");
+        if(pos != string::npos && pos >= 9) m_time = line.substr(pos - 9, 12);
+        if(pos != string::npos && pos >= 20) m_date = line.substr(pos - 20, 10);
     }
-    else if(Utils::startsWith("beam", line))
+    else if(Utils::startsWith("=========", line))
     {
-        add(line);
+        finishRecord();
+        Diagnostics::record(Diagnostics::timing_parse_line, start);
+        Diagnostics::traceStage(Diagnostics::trace_terminated);
+
+        usleep(10000);
+        return true;
+
     }
-    else if(Utils::startsWith("array", line))
+    else
     {
-        add(line);
+        //A line of no known component is only kept as text.
+        m_recordText.push_back(line);
     }
-    else if(Utils::startsWith("primary", line))
+
+    Diagnostics::record(Diagnostics::timing_parse_line, start);
+    return false;
+
+}
+
+/*
+ * Replace the contents with a record from the binary status feed.
+ * The display lines are composed from the parsed fields.
+ *
+ * @param header the record header.
+ * @param record the components of the record.
+ */
+void Components::setRecord(const StatusFeedHeader &header,
+        const vector<ComponentStatus> &record)
+{
+    char tempLine[64];
+    time_t recordTime = header.timestamp;
+    struct tm t;
+
+    startRecord(recordTime);
+    gmtime_r(&recordTime, &t);
+    strftime(tempLine, sizeof(tempLine), "%H:%M:%S UTC", &t);
+    m_time = tempLine;
+    strftime(tempLine, sizeof(tempLine), "%Y-%m-%d", &t);
+    m_date = tempLine;
+    if(header.activityId >= 0) m_activity = Utils::itos((int)header.activityId);
+
+    strftime(tempLine, sizeof(tempLine), "NSS  %Y-%m-%d %H:%M:%S UTC  Status", &t);
+    m_recordText.push_back(tempLine);
+    for(int i = 0; i < (int)record.size(); i++)
     {
-        add(line);
+        m_record.push_back(record[i]);
+        countComponent(record[i]);
+        m_recordText.push_back(record[i].toString());
+        add(m_recordText.back());
     }
-    else if(Utils::startsWith("NSS", line))
+
+    finishRecord();
+    Diagnostics::traceSource(recordTime);
+    Diagnostics::traceStage(Diagnostics::trace_terminated);
+}
+
+/*
+ * Get the header for the last record in the binary status feed.
+ *
+ * @return the header, with the record time, activity and frequency
+ * range filled in.
+ */
+StatusFeedHeader Components::getRecordHeader()
+{
+    StatusFeedHeader header;
+
+    header.timestamp = (int32_t)m_recordTime;
+    header.activityId = -1;
+    if(m_activity.size() > 0 && isdigit(m_activity[0]))
+        header.activityId = atoi(m_activity.c_str());
+    if(m_maxDxFreqMHz > 0)
     {
-        this->clear();
-        size_t pos = line.find("UTC");
-        if((int)pos >= 9 && pos != string::npos)
-            m_time = line.substr(pos - 9, 12); 
-        if((int)pos >= 20 && pos != string::npos)
-            m_date = line.substr(pos - 20, 10); 
-
-        m_chanTotalCount = 0;
-        m_chanRunningCount = 0;
-        m_dxOfflineCount = 0;
-        m_dxIdleCount = 0;
-        m_dxBaseAccumCount = 0;
-        m_dxDataCollCount = 0;
-        m_dxSigDetCount = 0;
-        m_dxTotalCount = 0;
-        m_minDxFreqMHz = 9999999.0;
-        m_maxDxFreqMHz = -1;
+        header.minDxFreqMHz = m_minDxFreqMHz;
+        header.maxDxFreqMHz = m_maxDxFreqMHz;
+    }
 
+    return header;
+}
+
+/*
+ * Start a new record. Empties the list and the counters.
+ *
+ * @param recordTime the UTC time of the record.
+ */
+void Components::startRecord(time_t recordTime)
+{
+    this->clear();
+    m_record.clear();
+    m_recordTime = recordTime;
+    m_recordText.clear();
+
+    m_chanTotalCount = 0;
+    m_chanRunningCount = 0;
+    m_dxOfflineCount = 0;
+    m_dxIdleCount = 0;
+    m_dxBaseAccumCount = 0;
+    m_dxDataCollCount = 0;
+    m_dxSigDetCount = 0;
+    m_dxTotalCount = 0;
+    m_unparsedCount = 0;
+    m_minDxFreqMHz = 9999999.0;
+    m_maxDxFreqMHz = -1;
+}
+
+/*
+ * Add a component to the record counters.
+ *
+ * @param status the component.
+ */
+void Components::countComponent(const ComponentStatus &status)
+{
+    if(status.kind == ComponentStatus::kind_chan)
+    {
+        m_chanTotalCount++;
+        if(status.state == ComponentStatus::state_running) m_chanRunningCount++;
     }
-    else if(Utils::startsWith("=========", line))
+    else if(status.kind == ComponentStatus::kind_dx)
     {
-        m_lastReportedCols  = -1;
-        m_lastReportedRows  = -1;
+        m_dxTotalCount++;
 
-        if(m_fullPageIndex == 0) m_fullPageIndex = 1;
-        else m_fullPageIndex = 0;
+        switch(status.state)
+        {
+            case ComponentStatus::state_offline:
+                m_dxOfflineCount++;
+                break;
+            case ComponentStatus::state_idle:
+                m_dxIdleCount++;
+                break;
+            case ComponentStatus::state_pend_base_accum:
+            case ComponentStatus::state_base_accum:
+            case ComponentStatus::state_base_accum_complete:
+                m_dxBaseAccumCount++;
+                break;
+            case ComponentStatus::state_pend_data_coll:
+            case ComponentStatus::state_data_coll:
+            case ComponentStatus::state_data_coll_complete:
+                m_dxDataCollCount++;
+                break;
+            case ComponentStatus::state_pend_sig_det:
+            case ComponentStatus::state_sig_det:
+            case ComponentStatus::state_sig_det_complete:
+                m_dxSigDetCount++;
+                break;
+            default:
+                break;
+        }
 
-        //Compose the channelizer summary string
-        m_channelizerSummary = "Total Channelizers=" + Utils::itos(m_chanTotalCount);
-        if(m_chanRunningCount> 0) m_channelizerSummary += 
-            ", Running=" + Utils::itos(m_chanRunningCount);
+        //Determine the min and max freq
+        if(status.channel > 0)
+        {
+            if(status.skyFreqMHz < m_minDxFreqMHz) m_minDxFreqMHz = status.skyFreqMHz;
+            if(status.skyFreqMHz > m_maxDxFreqMHz) m_maxDxFreqMHz = status.skyFreqMHz;
+        }
+    }
+}
 
-        //Dx Summary
-        m_dxSummary = "Total Dxs=" + Utils::itos(m_dxTotalCount);
-        if(m_dxOfflineCount > 0) m_dxSummary += ", Offline=" + Utils::itos(m_dxOfflineCount);
-        if(m_dxIdleCount>0) m_dxSummary += ", Idle=" + Utils::itos(m_dxIdleCount);
-        if(m_dxBaseAccumCount > 0) m_dxSummary += ", Base Accum=" + Utils::itos(m_dxBaseAccumCount);
-        if(m_dxDataCollCount > 0) m_dxSummary += ", Data Coll=" + Utils::itos(m_dxDataCollCount);
-        if(m_dxSigDetCount > 0) m_dxSummary += ", Sig Det=" + Utils::itos(m_dxSigDetCount);
+/*
+ * Finish a record. Composes the summary lines.
+ */
+void Components::finishRecord()
+{
+    m_lastReportedCols  = -1;
+    m_lastReportedRows  = -1;
 
-        m_detailsCount = Details::size();
+    if(m_fullPageIndex == 0) m_fullPageIndex = 1;
+    else m_fullPageIndex = 0;
 
-        usleep(10000);
-        return true;
+    //Compose the channelizer summary string, reusing the strings so
+    //that no record allocates for it.
+    m_channelizerSummary.assign("Total Channelizers=");
+    Utils::appendInt(m_channelizerSummary, m_chanTotalCount);
+    if(m_chanRunningCount> 0)
+    {
+        m_channelizerSummary.append(", Running=");
+        Utils::appendInt(m_channelizerSummary, m_chanRunningCount);
+    }
 
+    //Dx Summary
+    m_dxSummary.assign("Total Dxs=");
+    Utils::appendInt(m_dxSummary, m_dxTotalCount);
+    const char *labels[] = { ", Offline=", ", Idle=", ", Base Accum=",
+        ", Data Coll=", ", Sig Det=" };
+    int counts[] = { m_dxOfflineCount, m_dxIdleCount, m_dxBaseAccumCount,
+        m_dxDataCollCount, m_dxSigDetCount };
+    for(int i = 0; i < 5; i++)
+    {
+        if(counts[i] <= 0) continue;
+        m_dxSummary.append(labels[i]);
+        Utils::appendInt(m_dxSummary, counts[i]);
+    }
+    if(m_unparsedCount > 0)
+    {
+        m_dxSummary.append(", Unparsed=");
+        Utils::appendInt(m_dxSummary, m_unparsedCount);
     }
 
-    return false;
+    m_detailsCount = Details::size();
 
+    m_nameWidth = 6;
+    for(int i = 0; i < (int)m_record.size(); i++)
+    {
+        int width = (int)strnlen(m_record[i].name, ComponentStatus::MAX_NAME);
+        if(width > m_nameWidth) m_nameWidth = width;
+    }
 }
 
 /*
@@ -324,7 +439,7 @@ bool Components::paint(int pageNum, int pageCols, int pageRows)
         {
             std::pair<string, string> keyval = Details::get(vectorIndex);
             line = (string)keyval.first;
-            line.resize(9, ' ');
+            line.resize(m_nameWidth + 3, ' ');
             line += (string)keyval.second;
             line.resize(pageCols, ' ');
 
@@ -346,11 +461,11 @@ bool Components::paint(int pageNum, int pageCols, int pageRows)
 
             //Highlight the second column with state color coding.
             if(line.find("Offline") != string::npos)
-                Utils::drawSquare(startRow+i, 7, 8);
+                Utils::drawSquare(startRow+i, m_nameWidth + 1, 8);
             else if(line.find("Run") != string::npos)
-                Utils::drawSquare(startRow+i, 7, 10);
+                Utils::drawSquare(startRow+i, m_nameWidth + 1, 10);
             else
-                Utils::drawSquare(startRow+i, 7, 9);
+                Utils::drawSquare(startRow+i, m_nameWidth + 1, 9);
 
 
         }
@@ -382,6 +497,108 @@ bool Components::paint(int pageNum, int pageCols, int pageRows)
 
 }
 
+/*
+ * Append a component to the record, with the fields read from its
+ * line by the status grammar.
+ *
+ * @param line the status line.
+ * @param id the id of the component in m_registry, -1 if the
+ * registry is full.
+ * @param kind the ComponentStatus::component_kind_t of the line.
+ * @param fields the fields of the line, NULL if it did not match the
+ * grammar.
+ * @return the new entry in the record.
+ */
+ComponentStatus &Components::recordComponent(const string &line, int id, int kind,
+        const StatusLine *fields)
+{
+    ComponentStatus status;
+
+    if(id >= 0) status.setName(m_registry.getName(id));
+    else status.setName(line.substr(0, line.find_first_of(" \t")));
+    status.kind = (uint8_t)kind;
+
+    int state = ComponentStatus::state_last;
+    if(fields != NULL)
+        state = StatusGrammar::parseState(status.kind, fields->state, fields->stateLength);
+
+    if(state != ComponentStatus::state_last)
+    {
+        status.state = (uint8_t)state;
+        status.timestamp = (int32_t)fields->timestamp;
+        status.activityId = fields->activityId;
+        status.skyFreqMHz = fields->skyFreqMHz;
+        status.channel = fields->channel;
+    }
+    else
+    {
+        //Not in the grammar, or a state it does not know, so the format
+        //may have changed. Every dx state has a phrase, other components
+        //may report anything. Take what can be found.
+        //dx1001 (beam1) 2010-08-07 00:19:34 UTC  Act 2735: Init  Sky: 8424.914 MHz Chan: 13
+        if(fields == NULL || status.kind == ComponentStatus::kind_dx || id < 0)
+            m_unparsedCount++;
+        status.state = (uint8_t)ComponentStatus::parseState(status.kind, line);
+        status.timestamp = (int32_t)ComponentStatus::parseTime(line);
+
+        const char *text = line.c_str();
+        const char *textEnd = text + line.size();
+        long number;
+        double freq;
+
+        size_t pos = line.find("Act ");
+        size_t pos2 = (pos == string::npos) ? pos : line.find(':', pos);
+        if(pos2 != string::npos && Utils::parseInt(text + pos + 4, text + pos2, number))
+            status.activityId = (int32_t)number;
+
+        pos = line.find("Chan:");
+        if(pos != string::npos && Utils::parseInt(text + pos + 5, textEnd, number))
+            status.channel = (int32_t)number;
+
+        pos = line.find("Sky:");
+        pos2 = (pos == string::npos) ? pos : line.find("MHz", pos);
+        if(pos2 != string::npos && Utils::parseFloat(text + pos + 4, text + pos2, freq))
+            status.skyFreqMHz = (float)freq;
+    }
+
+    m_record.push_back(status);
+    return m_record.back();
+}
+
+/*
+ * Get the parsed components of the last record.
+ *
+ * @return one ComponentStatus per component line in the record.
+ */
+const vector<ComponentStatus> &Components::getRecord()
+{
+    return m_record;
+}
+
+/*
+ * Get the text of the lines of the last record, as read from
+ * "sse-system-status.txt" without their line endings. It starts
+ * with the "NSS" header and leaves out the "=====" line. A
+ * record from the binary status feed has the lines composed
+ * from its parsed fields.
+ *
+ * @return the lines of the record.
+ */
+const vector<string> &Components::getRecordText()
+{
+    return m_recordText;
+}
+
+/*
+ * Get the UTC time of the last record, from its "NSS" header.
+ *
+ * @return the UTC time in seconds since 1/1/70, or 0 if unknown.
+ */
+time_t Components::getRecordTime()
+{
+    return m_recordTime;
+}
+
 /*
  * Get the number of pages required to display all the information.
  *
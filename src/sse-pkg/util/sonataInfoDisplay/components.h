@@ -36,6 +36,10 @@
 #define COMPONENTS_H
 
 #include "details.h" 
+#include "componentstatus.h"
+#include "statusfeed.h"
+#include "componentregistry.h"
+#include "statusgrammar.h"
 
 using namespace std;
 
@@ -97,8 +101,85 @@ class Components: public Details
          */
         bool paint(int pageNum, int pageCols, int pageRows);
 
+        /**
+         * Get the parsed components of the last record.
+         *
+         * @return one ComponentStatus per component line in the record.
+         */
+        const vector<ComponentStatus> &getRecord();
+
+        /**
+         * Get the text of the lines of the last record, as read from
+         * "sse-system-status.txt" without their line endings. It starts
+         * with the "NSS" header and leaves out the "=====" line. A
+         * record from the binary status feed has the lines composed
+         * from its parsed fields.
+         *
+         * @return the lines of the record.
+         */
+        const vector<string> &getRecordText();
+
+        /**
+         * Get the UTC time of the last record, from its "NSS" header.
+         *
+         * @return the UTC time in seconds since 1/1/70, or 0 if unknown.
+         */
+        time_t getRecordTime();
+
+        /**
+         * Get the header for the last record in the binary status feed.
+         *
+         * @return the header, with the record time, activity and frequency
+         * range filled in.
+         */
+        StatusFeedHeader getRecordHeader();
+
+        /**
+         * Replace the contents with a record from the binary status feed.
+         * The display lines are composed from the parsed fields.
+         *
+         * @param header the record header.
+         * @param record the components of the record.
+         */
+        void setRecord(const StatusFeedHeader &header,
+                const vector<ComponentStatus> &record);
 
     private:
+
+        /**
+         * Append a component to the record, with the fields read from its
+         * line by the status grammar.
+         *
+         * @param line the status line.
+         * @param id the id of the component in m_registry, -1 if the
+         * registry is full.
+         * @param kind the ComponentStatus::component_kind_t of the line.
+         * @param fields the fields of the line, NULL if it did not match the
+         * grammar.
+         * @return the new entry in the record.
+         */
+        ComponentStatus &recordComponent(const string &line, int id, int kind,
+                const StatusLine *fields);
+
+        /**
+         * Start a new record. Empties the list and the counters.
+         *
+         * @param recordTime the UTC time of the record.
+         */
+        void startRecord(time_t recordTime);
+
+        /**
+         * Add a component to the record counters.
+         *
+         * @param status the component.
+         */
+        void countComponent(const ComponentStatus &status);
+
+        /**
+         * Finish a record. Composes the summary lines.
+         */
+        void finishRecord();
+
         int m_lastRequestedPage;
         int m_lastReportedCols;
         int m_lastReportedRows;
@@ -114,6 +195,12 @@ class Components: public Details
 
         std::vector<string> m_screenBuffer;
 
+        std::vector<ComponentStatus> m_record;
+        time_t m_recordTime;
+
+        /** The text of the lines of the record, see getRecordText(). */
+        std::vector<string> m_recordText;
+
         int m_chanTotalCount;
         int m_chanRunningCount;
         int m_dxOfflineCount;
@@ -122,15 +209,28 @@ class Components: public Details
         int m_dxDataCollCount;
         int m_dxSigDetCount;
         int m_dxTotalCount;
+
+        /** Lines in the record that did not match the status grammar. */
+        int m_unparsedCount;
         float m_minDxFreqMHz;
         float m_maxDxFreqMHz;
         int m_detailsCount;
 
+        /** The width of the longest component name in the record, at
+         * least that of "dx1000". Federated names are longer. */
+        int m_nameWidth;
+
         string m_channelizerSummary;
         string m_dxSummary;
 
         int m_lastFreqRangeStringLen;
 
+        /** The components seen so far, to identify each line in one lookup. */
+        ComponentRegistry m_registry;
+
+        /** Reads the fields of each line. */
+        StatusGrammar m_grammar;
+
 };
 
 
@@ -0,0 +1,266 @@
+/*
+ * componentstatus.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * The parsed state of one system component from a status record.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file componentstatus.cpp
+ * The parsed state of one system component from a status record.
+ */
+
+#include "componentstatus.h"
+#include "utils.h"
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Constructor. Initializes an unknown component.
+ */
+ComponentStatus::ComponentStatus()
+{
+    memset(name, 0, sizeof(name));
+    kind = kind_unknown;
+    state = state_unknown;
+    pad = 0;
+    activityId = -1;
+    skyFreqMHz = 0.0;
+    channel = -1;
+    timestamp = 0;
+}
+
+/*
+ * Set the component name. Names longer than MAX_NAME-1 are truncated.
+ *
+ * @param componentName the component name.
+ */
+void ComponentStatus::setName(const string &componentName)
+{
+    memset(name, 0, sizeof(name));
+    strncpy(name, componentName.c_str(), MAX_NAME - 1);
+}
+
+/*
+ * Determine the kind of a component from its name.
+ *
+ * @param componentName the name such as "dx1000".
+ * @return the component_kind_t value.
+ */
+ComponentStatus::component_kind_t ComponentStatus::parseKind(
+        const string &componentName)
+{
+    if(Utils::startsWith("chan", componentName)) return kind_chan;
+    if(Utils::startsWith("dx", componentName)) return kind_dx;
+    if(Utils::startsWith("arch", componentName)) return kind_arch;
+    if(Utils::startsWith("tscope", componentName)) return kind_tscope;
+    if(Utils::startsWith("beam", componentName)) return kind_beam;
+    if(Utils::startsWith("array", componentName)) return kind_array;
+    if(Utils::startsWith("primary", componentName)) return kind_primary;
+
+    return kind_unknown;
+}
+
+/*
+ * Determine the state of a component from its status line.
+ *
+ * @param kind the kind of component the line is for.
+ * @param line the status line.
+ * @return the component_state_t value.
+ */
+ComponentStatus::component_state_t ComponentStatus::parseState(int kind,
+        const string &line)
+{
+    if(line.find("ffline") != string::npos) return state_offline;
+
+    if(kind != kind_dx)
+    {
+        if(line.find("Run") != string::npos) return state_running;
+        return state_unknown;
+    }
+
+    if(line.find("No Activities") != string::npos) return state_idle;
+
+    //The state text follows the activity number up to the sky frequency:
+    //dx1001 (beam1) 2010-08-07 00:19:34 UTC  Act 2735: Init  Sky: 8424.914 MHz Chan: 13
+    size_t pos = line.find("Act ");
+    if(pos == string::npos) return state_unknown;
+    pos = line.find(": ", pos);
+    if(pos == string::npos) return state_unknown;
+
+    size_t end = line.find("Sky:", pos);
+    string text = line.substr(pos + 2,
+            (end == string::npos) ? string::npos : end - pos - 2);
+
+    //Each of the three processing phases can be pending, running or
+    //complete, e.g. "Pend Data Coll", "Data Coll", "Data Coll Complete".
+    static const struct
+    {
+        const char *name;
+        component_state_t pendingState;
+    } phases[] = {
+        { "Base Accum", state_pend_base_accum },
+        { "Data Coll",  state_pend_data_coll },
+        { "Sig Det",    state_pend_sig_det }
+    };
+
+    for(int i = 0; i < (int)(sizeof(phases)/sizeof(phases[0])); i++)
+    {
+        size_t phasePos = text.find(phases[i].name);
+        if(phasePos == string::npos) continue;
+
+        if(text.find("Pend") != string::npos)
+            return phases[i].pendingState;
+        if(text.find("Complete", phasePos) != string::npos)
+            return (component_state_t)(phases[i].pendingState + 2);
+        return (component_state_t)(phases[i].pendingState + 1);
+    }
+
+    if(text.find("Init") != string::npos) return state_init;
+    if(text.find("Tuned") != string::npos) return state_tuned;
+    if(text.find("Complete") != string::npos) return state_complete;
+    if(text.find("Stopping") != string::npos) return state_stopping;
+    if(text.find("Stopped") != string::npos) return state_stopped;
+    if(text.find("Error") != string::npos) return state_error;
+
+    return state_unknown;
+}
+
+/*
+ * Read the "YYYY-MM-DD HH:MM:SS UTC" time in a status line.
+ *
+ * @param line the status line.
+ * @param utcOffset if not NULL, set to the offset of " UTC" in the
+ * line when a time is found.
+ * @return the UTC time in seconds since 1/1/70, or 0 if the line
+ * does not contain a time.
+ */
+time_t ComponentStatus::parseTime(const string &line, size_t *utcOffset)
+{
+    size_t pos = line.find(" UTC");
+    if(pos == string::npos || pos < 19) return 0;
+
+    struct tm t;
+    memset(&t, 0, sizeof(t));
+    if(sscanf(line.c_str() + pos - 19, "%4d-%2d-%2d %2d:%2d:%2d",
+                &t.tm_year, &t.tm_mon, &t.tm_mday,
+                &t.tm_hour, &t.tm_min, &t.tm_sec) != 6)
+        return 0;
+
+    t.tm_year -= 1900;
+    t.tm_mon -= 1;
+
+    if(utcOffset != NULL) *utcOffset = pos;
+    return timegm(&t);
+}
+
+/*
+ * Compose a status line from the fields, for records that arrive
+ * without their text (e.g. from the binary status feed). Only the
+ * parsed fields are shown.
+ *
+ * @return the status line.
+ */
+string ComponentStatus::toString() const
+{
+    char line[128];
+    char timeText[32] = "";
+    time_t t = timestamp;
+    struct tm tmTime;
+
+    if(timestamp > 0 && gmtime_r(&t, &tmTime) != NULL)
+        strftime(timeText, sizeof(timeText), "%Y-%m-%d %H:%M:%S UTC", &tmTime);
+
+    if(kind == kind_dx && activityId >= 0)
+    {
+        snprintf(line, sizeof(line), "%s %s  Act %d: %s  Sky: %.3f MHz Chan: %d",
+                name, timeText, (int)activityId, stateName(state),
+                skyFreqMHz, (int)channel);
+    }
+    else
+    {
+        snprintf(line, sizeof(line), "%s %s  %s", name, timeText,
+                stateName(state));
+    }
+
+    return line;
+}
+
+/*
+ * Get a short name for a state, suitable for a table column.
+ *
+ * @param state the component_state_t value.
+ * @return the name.
+ */
+const char *ComponentStatus::stateName(int state)
+{
+    static const char *names[state_last] = {
+        "Unknown",
+        "Offline",
+        "Idle",
+        "Init",
+        "Tuned",
+        "Pend Base Accum",
+        "Base Accum",
+        "Base Accum Done",
+        "Pend Data Coll",
+        "Data Coll",
+        "Data Coll Done",
+        "Pend Sig Det",
+        "Sig Det",
+        "Sig Det Done",
+        "Complete",
+        "Stopping",
+        "Stopped",
+        "Error",
+        "Running"
+    };
+
+    if(state < 0 || state >= state_last) return names[state_unknown];
+    return names[state];
+}
+
+/*
+ * Get the name of a kind of component.
+ *
+ * @param kind the component_kind_t value.
+ * @return the name.
+ */
+const char *ComponentStatus::kindName(int kind)
+{
+    static const char *names[kind_last] = {
+        "unknown",
+        "chan",
+        "dx",
+        "arch",
+        "tscope",
+        "beam",
+        "array",
+        "primary"
+    };
+
+    if(kind < 0 || kind >= kind_last) return names[kind_unknown];
+    return names[kind];
+}
@@ -0,0 +1,190 @@
+/*
+ * componentstatus.h
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * The parsed state of one system component from a status record.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file componentstatus.h
+ * The parsed state of one system component from a status record.
+ */
+
+#ifndef COMPONENTSTATUS_H
+#define COMPONENTSTATUS_H
+
+#include <string>
+#include <time.h>
+#include <stdint.h>
+
+using namespace std;
+
+/**
+ * The parsed state of one system component (channelizer, dx, archiver,
+ * etc.) taken from one line of a "sse-system-status.txt" record.
+ *
+ * This is a fixed size structure so that it can be copied around
+ * without any allocation.
+ */
+struct ComponentStatus
+{
+    /**
+     * The kind of component, taken from the start of the status line.
+     */
+    enum component_kind_t
+    {
+        kind_unknown,
+        kind_chan,
+        kind_dx,
+        kind_arch,
+        kind_tscope,
+        kind_beam,
+        kind_array,
+        kind_primary,
+        kind_last
+    };
+
+    /**
+     * The state of the component. The activity states follow the
+     * order of PdmActivityState in ssePdmInterface.h, the rest cover
+     * the non-dx components and the lines without an activity.
+     */
+    enum component_state_t
+    {
+        state_unknown,
+        state_offline,
+        state_idle,
+        state_init,
+        state_tuned,
+        state_pend_base_accum,
+        state_base_accum,
+        state_base_accum_complete,
+        state_pend_data_coll,
+        state_data_coll,
+        state_data_coll_complete,
+        state_pend_sig_det,
+        state_sig_det,
+        state_sig_det_complete,
+        state_complete,
+        state_stopping,
+        state_stopped,
+        state_error,
+        state_running,
+        state_last
+    };
+
+    /** The maximum length of a component name, including the '\\0'. */
+    static const int MAX_NAME = 16;
+
+    /** The component name such as "dx1000" or "chan1x". */
+    char name[MAX_NAME];
+
+    /** The kind of component, a component_kind_t value. */
+    uint8_t kind;
+
+    /** The state of the component, a component_state_t value. */
+    uint8_t state;
+
+    /** Alignment padding. */
+    uint16_t pad;
+
+    /** The activity id, -1 if there is no activity. */
+    int32_t activityId;
+
+    /** The sky frequency in MHz, 0 if not known. */
+    float skyFreqMHz;
+
+    /** The channel number, -1 if not known. */
+    int32_t channel;
+
+    /** The UTC time (seconds since 1/1/70) on the status line. */
+    int32_t timestamp;
+
+    /** Constructor. Initializes an unknown component. */
+    ComponentStatus();
+
+    /**
+     * Compose a status line from the fields, for records that arrive
+     * without their text (e.g. from the binary status feed). Only the
+     * parsed fields are shown.
+     *
+     * @return the status line.
+     */
+    string toString() const;
+
+    /**
+     * Set the component name. Names longer than MAX_NAME-1 are truncated.
+     *
+     * @param componentName the component name.
+     */
+    void setName(const string &componentName);
+
+    /**
+     * Determine the kind of a component from its name.
+     *
+     * @param componentName the name such as "dx1000".
+     * @return the component_kind_t value.
+     */
+    static component_kind_t parseKind(const string &componentName);
+
+    /**
+     * Determine the state of a component from its status line.
+     *
+     * @param kind the kind of component the line is for.
+     * @param line the status line.
+     * @return the component_state_t value.
+     */
+    static component_state_t parseState(int kind, const string &line);
+
+    /**
+     * Read the "YYYY-MM-DD HH:MM:SS UTC" time in a status line.
+     *
+     * @param line the status line.
+     * @param utcOffset if not NULL, set to the offset of " UTC" in the
+     * line when a time is found.
+     * @return the UTC time in seconds since 1/1/70, or 0 if the line
+     * does not contain a time.
+     */
+    static time_t parseTime(const string &line, size_t *utcOffset = NULL);
+
+    /**
+     * Get a short name for a state, suitable for a table column.
+     *
+     * @param state the component_state_t value.
+     * @return the name.
+     */
+    static const char *stateName(int state);
+
+    /**
+     * Get the name of a kind of component.
+     *
+     * @param kind the component_kind_t value.
+     * @return the name.
+     */
+    static const char *kindName(int kind);
+};
+
+#endif //COMPONENTSTATUS_H
+
@@ -177,6 +177,15 @@ class Details
          */
         virtual bool paint(int pageNum, int pageCols, int pageRows){ return false;};
 
+        /**
+         * Handle a key press that the screen itself does not use.
+         *
+         * @param ch the key, as returned by getch().
+         * @return true if the key changed what is displayed and the
+         * screen should be repainted, else false.
+         */
+        virtual bool processKey(int) { return false; };
+
 
         enum detail_t
         {
@@ -184,6 +193,9 @@ class Details
             detail_signals,
             detail_errors,
             detail_summary,
+            detail_activity,
+            detail_history,
+            detail_diagnostics,
             detail_top,
             detail_bottom,
             detail_type_unknown
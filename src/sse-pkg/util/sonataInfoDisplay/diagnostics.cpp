@@ -0,0 +1,421 @@
+/*
+ * diagnostics.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Counts and times the work done by sonataInfoDisplay.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file diagnostics.cpp
+ * Counts and times the work done by sonataInfoDisplay.
+ */
+
+#include "diagnostics.h"
+#include "utils.h"
+#include <ncurses.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+/** Rows above the table: time and title, legend. */
+#define DIAGNOSTICS_HEADER_ROWS 2
+
+/** The line of format() with the counter column headings. */
+#define DIAGNOSTICS_COUNTER_HEADING 0
+
+/** The line of format() with the timing column headings. */
+#define DIAGNOSTICS_TIMING_HEADING (Diagnostics::counter_last + 2)
+
+/** The line of format() with the latency column headings. */
+#define DIAGNOSTICS_LATENCY_HEADING (DIAGNOSTICS_TIMING_HEADING + Diagnostics::timing_last + 2)
+
+uint64_t Diagnostics::m_counters[Diagnostics::counter_last];
+LatencyHistogram Diagnostics::m_timings[Diagnostics::timing_last];
+volatile sig_atomic_t Diagnostics::m_dumpRequested = 0;
+uint64_t Diagnostics::m_startTicks = 0;
+uint64_t Diagnostics::m_startNanoseconds = 0;
+LatencyHistogram Diagnostics::m_latencies[Diagnostics::latency_last];
+uint64_t Diagnostics::m_lateRecords = 0;
+bool Diagnostics::m_traceOpen = false;
+uint64_t Diagnostics::m_traceTicks[Diagnostics::trace_last];
+uint64_t Diagnostics::m_traceReadMicroseconds = 0;
+time_t Diagnostics::m_traceSource = 0;
+bool Diagnostics::m_traceForced = false;
+
+/*
+ * Constructor. Starts the clock calibration and catches SIGUSR1.
+ */
+Diagnostics::Diagnostics() : Details()
+{
+    m_thisType = detail_diagnostics;
+
+    m_startTicks = now();
+    m_startNanoseconds = getNanoseconds();
+
+    m_rateNanoseconds = m_startNanoseconds;
+    for(int i = 0; i < counter_last; i++)
+    {
+        m_rateCounters[i] = 0;
+        m_rates[i] = 0.0;
+    }
+
+    (void) signal(SIGUSR1, Diagnostics::dumpSignal);
+}
+
+/*
+ * Start tracing a record when its first line is read. Does
+ * nothing if a record is already being traced.
+ */
+void Diagnostics::traceRead()
+{
+    struct timeval t;
+
+    if(m_traceOpen) return;
+
+    m_traceOpen = true;
+    for(int i = 0; i < trace_last; i++) m_traceTicks[i] = 0;
+    m_traceTicks[trace_read] = now();
+    gettimeofday(&t, NULL);
+    m_traceReadMicroseconds = (uint64_t)t.tv_sec * 1000000ULL + t.tv_usec;
+    m_traceSource = 0;
+    m_traceForced = false;
+}
+
+/*
+ * Set the time on the "NSS" line of the record being traced.
+ *
+ * @param sourceTime the UTC time, seconds since 1/1/70.
+ */
+void Diagnostics::traceSource(time_t sourceTime)
+{
+    if(m_traceOpen) m_traceSource = sourceTime;
+}
+
+/*
+ * Finish the record being traced and record its latencies. A
+ * record that missed a stage or has no "NSS" time is dropped.
+ */
+void Diagnostics::traceEnd()
+{
+    if(!m_traceOpen) return;
+    m_traceOpen = false;
+
+    if(m_traceSource <= 0) return;
+    for(int i = 0; i < trace_last; i++)
+        if(m_traceTicks[i] == 0) return;
+
+    //The clocks of the writer and this machine may disagree a little.
+    uint64_t sourceMicroseconds = (uint64_t)m_traceSource * 1000000ULL;
+    uint64_t sourceToRead = 0;
+    if(m_traceReadMicroseconds > sourceMicroseconds)
+        sourceToRead = m_traceReadMicroseconds - sourceMicroseconds;
+
+    double scale = 1.0 / getTicksPerMicrosecond();
+    uint64_t stages[trace_last - 1];
+    uint64_t total = sourceToRead;
+    for(int i = 0; i < trace_last - 1; i++)
+    {
+        uint64_t ticks = 0;
+        if(m_traceTicks[i + 1] > m_traceTicks[i]) ticks = m_traceTicks[i + 1] - m_traceTicks[i];
+        stages[i] = (uint64_t)(ticks * scale);
+        total += stages[i];
+    }
+
+    //The stages of a forced record hold the timer, not the display.
+    if(m_traceForced)
+    {
+        m_latencies[latency_forced_source_to_painted].record(total);
+        return;
+    }
+
+    m_latencies[latency_source_to_read].record(sourceToRead);
+    m_latencies[latency_read_to_terminated].record(stages[0]);
+    m_latencies[latency_terminated_to_published].record(stages[1]);
+    m_latencies[latency_published_to_painted].record(stages[2]);
+    m_latencies[latency_source_to_painted].record(total);
+
+    if(total > DIAGNOSTICS_LATE_SECS * 1000000ULL) m_lateRecords++;
+}
+
+/*
+ * Get the number of ticks per microsecond, measured over the
+ * run so far.
+ *
+ * @return the ticks per microsecond.
+ */
+double Diagnostics::getTicksPerMicrosecond()
+{
+    uint64_t ticks = now() - m_startTicks;
+    uint64_t nanoseconds = getNanoseconds() - m_startNanoseconds;
+
+    if(ticks == 0 || nanoseconds == 0) return 1.0;
+    return (double)ticks * 1000.0 / (double)nanoseconds;
+}
+
+/*
+ * The SIGUSR1 handler. Asks for a dump.
+ *
+ * @param sig the signal.
+ */
+void Diagnostics::dumpSignal(int)
+{
+    m_dumpRequested = 1;
+}
+
+/*
+ * Check if a dump has been asked for with SIGUSR1.
+ *
+ * @return true if a dump is wanted.
+ */
+bool Diagnostics::isDumpRequested()
+{
+    return m_dumpRequested != 0;
+}
+
+/*
+ * Append the counters and timings to a file.
+ *
+ * @param filename the file, e.g. DIAGNOSTICS_DUMP_FILE.
+ * @return true if written, else false.
+ */
+bool Diagnostics::dump(const string &filename)
+{
+    char timeText[32];
+    vector<string> lines;
+
+    m_dumpRequested = 0;
+
+    FILE *fp = fopen(filename.c_str(), "a");
+    if(fp == NULL) return false;
+
+    time_t t = time(NULL);
+    struct tm tmTime;
+    gmtime_r(&t, &tmTime);
+    strftime(timeText, sizeof(timeText), "%Y-%m-%d %H:%M:%S UTC", &tmTime);
+    fprintf(fp, "sonataInfoDisplay diagnostics, pid %d, %s\n", (int)getpid(), timeText);
+
+    format(lines);
+    for(int i = 0; i < (int)lines.size(); i++) fprintf(fp, "%s\n", lines[i].c_str());
+    fprintf(fp, "\n");
+
+    return fclose(fp) == 0;
+}
+
+/*
+ * Display the information on the screen.
+ *
+ * @param pageNum the page number to display.
+ * @param pageCols the number of columns on the screen.
+ * @param pageRows the number of rows on the screen.
+ * @return true if screen has changed, else false.
+ */
+bool Diagnostics::paint(int, int pageCols, int pageRows)
+{
+    char tempLine[128];
+    string blank(pageCols, ' ');
+    string line;
+    vector<string> lines;
+
+    //Draw the header
+    string headerString = "SonATA Diagnostics";
+    time_t t = time(NULL);
+    struct tm tmTime;
+    gmtime_r(&t, &tmTime);
+    strftime(tempLine, sizeof(tempLine), "%H:%M:%S UTC", &tmTime);
+    move(0,0);
+    addstr(blank.c_str());
+    move(0,0);
+    addstr(tempLine);
+    Utils::drawColorText(0, pageCols/2 - headerString.size()/2, 3, headerString);
+
+    snprintf(tempLine, sizeof(tempLine),
+            "Rates over %d s, times in us. SIGUSR1 dumps to %s",
+            DIAGNOSTICS_RATE_SECS, DIAGNOSTICS_DUMP_FILE);
+    line = tempLine;
+    line.resize(pageCols, ' ');
+    move(1,0);
+    addstr(line.c_str());
+
+    format(lines);
+    for(int row = DIAGNOSTICS_HEADER_ROWS; row < pageRows; row++)
+    {
+        int index = row - DIAGNOSTICS_HEADER_ROWS;
+        line = (index < (int)lines.size()) ? lines[index] : "";
+        line.resize(pageCols, ' ');
+
+        if(index == DIAGNOSTICS_COUNTER_HEADING || index == DIAGNOSTICS_TIMING_HEADING ||
+                index == DIAGNOSTICS_LATENCY_HEADING)
+            Utils::drawColorText(row, 0, 2, line);
+        else
+        {
+            move(row, 0);
+            addstr(line.c_str());
+        }
+    }
+
+    //Park the cursor in the lower right corner
+    move(pageRows-1, pageCols-1);
+
+    return true;
+}
+
+/*
+ * Get the number of pages required to display all the information.
+ *
+ * @param pageRows the number of rows available on the screen.
+ * @return the number of pages required to display all the
+ * information.
+ */
+int Diagnostics::getNumPages(int)
+{
+    return 1;
+}
+
+/*
+ * Get the type of this object inherited from the Details class.
+ *
+ * @return the type as a detail_t enum value.
+ */
+int Diagnostics::getType()
+{
+    return m_thisType;
+}
+
+/*
+ * Get the current page number displayed.
+ *
+ * @return the current page number displayed.
+ */
+int Diagnostics::getCurrentPageNumber()
+{
+    return 1;
+}
+
+/*
+ * Read the monotonic clock.
+ *
+ * @return the time in nanoseconds.
+ */
+uint64_t Diagnostics::getNanoseconds()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+/*
+ * Format the counters, timings and latencies as lines of text.
+ * The column headings are at DIAGNOSTICS_COUNTER_HEADING,
+ * DIAGNOSTICS_TIMING_HEADING and DIAGNOSTICS_LATENCY_HEADING.
+ *
+ * @param lines set to the lines.
+ */
+void Diagnostics::format(vector<string> &lines)
+{
+    static const char *counterNames[counter_last] = {
+        "Select wakeups",
+        "Bytes read",
+        "Status lines parsed",
+        "Records completed",
+        "Records forced",
+        "Screen paints",
+        "Cells touched"
+    };
+    static const char *timingNames[timing_last] = {
+        "Select wait",
+        "Status line parse",
+        "Screen paint"
+    };
+    static const char *latencyNames[latency_last] = {
+        "NSS time to read",
+        "Read to =====",
+        "===== to publish",
+        "Publish to paint",
+        "NSS time to paint",
+        "Forced, to paint"
+    };
+    char line[128];
+
+    //Start a new rate period once the last is long enough.
+    uint64_t nanoseconds = getNanoseconds();
+    if(nanoseconds - m_rateNanoseconds >= DIAGNOSTICS_RATE_SECS * 1000000000ULL)
+    {
+        double seconds = (nanoseconds - m_rateNanoseconds) / 1e9;
+        for(int i = 0; i < counter_last; i++)
+        {
+            m_rates[i] = (m_counters[i] - m_rateCounters[i]) / seconds;
+            m_rateCounters[i] = m_counters[i];
+        }
+        m_rateNanoseconds = nanoseconds;
+    }
+
+    lines.clear();
+    snprintf(line, sizeof(line), "%-20s %14s %12s", "Counter", "Total", "Per sec");
+    lines.push_back(line);
+    for(int i = 0; i < counter_last; i++)
+    {
+        snprintf(line, sizeof(line), "%-20s %14llu %12.1f", counterNames[i],
+                (unsigned long long)m_counters[i], m_rates[i]);
+        lines.push_back(line);
+    }
+
+    lines.push_back("");
+    snprintf(line, sizeof(line), "%-20s %10s %9s %9s %9s %9s %9s", "Timing",
+            "Count", "Min", "Mean", "50%", "99%", "Max");
+    lines.push_back(line);
+
+    double scale = 1.0 / getTicksPerMicrosecond();
+    for(int i = 0; i < timing_last; i++)
+    {
+        const LatencyHistogram &timing = m_timings[i];
+        snprintf(line, sizeof(line), "%-20s %10llu %9.1f %9.1f %9.1f %9.1f %9.1f",
+                timingNames[i], (unsigned long long)timing.getCount(),
+                timing.getMin() * scale, timing.getMean() * scale,
+                timing.getPercentile(50.0) * scale,
+                timing.getPercentile(99.0) * scale, timing.getMax() * scale);
+        lines.push_back(line);
+    }
+
+    lines.push_back("");
+    snprintf(line, sizeof(line), "%-20s %10s %9s %9s %9s %9s %9s", "Record latency, ms",
+            "Count", "Min", "Mean", "50%", "99%", "Max");
+    lines.push_back(line);
+
+    for(int i = 0; i < latency_last; i++)
+    {
+        const LatencyHistogram &latency = m_latencies[i];
+        snprintf(line, sizeof(line), "%-20s %10llu %9.1f %9.1f %9.1f %9.1f %9.1f",
+                latencyNames[i], (unsigned long long)latency.getCount(),
+                latency.getMin() / 1000.0, latency.getMean() / 1000.0,
+                latency.getPercentile(50.0) / 1000.0,
+                latency.getPercentile(99.0) / 1000.0, latency.getMax() / 1000.0);
+        lines.push_back(line);
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "Records over %d s", DIAGNOSTICS_LATE_SECS);
+    snprintf(line, sizeof(line), "%-20s %10llu", name, (unsigned long long)m_lateRecords);
+    lines.push_back(line);
+}
@@ -0,0 +1,356 @@
+/*
+ * diagnostics.h
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Counts and times the work done by sonataInfoDisplay.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file diagnostics.h
+ * Counts and times the work done by sonataInfoDisplay.
+ */
+
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include "details.h"
+#include "latencyhistogram.h"
+#include <signal.h>
+#include <stdint.h>
+#include <time.h>
+
+using namespace std;
+
+/** The file the diagnostics are appended to on SIGUSR1. */
+#define DIAGNOSTICS_DUMP_FILE "/tmp/sonataInfoDisplay-diagnostics.txt"
+
+/** The rates are taken over at least this many seconds. */
+#define DIAGNOSTICS_RATE_SECS 5
+
+/** A record painted more than this many seconds after its NSS time is late. */
+#define DIAGNOSTICS_LATE_SECS 3
+
+/**
+ * Counts and times the work done by sonataInfoDisplay: waiting in
+ * select(), reading, parsing the status lines, completing records and
+ * painting the screen.
+ *
+ * Counting and timing are static inline functions so that they cost a
+ * few instructions where they are called. Times are taken from the CPU
+ * time stamp counter where there is one, and are kept as ticks in a
+ * LatencyHistogram; ticks are only turned into microseconds for
+ * display, calibrated against the monotonic clock over the whole run.
+ * The display runs in one thread, so the counters need no locking, and
+ * the SIGUSR1 handler only sets a flag for the main loop to act on.
+ *
+ * Each status record is also traced from the time on its "NSS" line,
+ * through the first of its lines being read, its "=====" line (or the
+ * timer standing in for it), its publishing to the feed, board and
+ * headless clients, to the screen being painted. The time between each
+ * stage goes into a histogram of its own, and the whole in another, to
+ * show how far behind reality the screen is. The "NSS" time is in whole
+ * seconds, so the first stage and the whole read up to a second long.
+ * When headless the paint stage is empty. A forced record has waited
+ * out the timer, so only its whole is kept, in a histogram apart.
+ *
+ * Inherits from the Details class to show the counters and timings on
+ * a screen of their own. The same text is appended to
+ * DIAGNOSTICS_DUMP_FILE on SIGUSR1, also when headless.
+ */
+class Diagnostics: public Details
+{
+    public:
+
+        /**
+         * The counters.
+         */
+        enum counter_t
+        {
+            /** Returns from select() in Logfile::readLogfiles(). */
+            counter_select_wakeups,
+            /** Bytes read from the status and log files. */
+            counter_bytes_read,
+            /** Lines passed to Components::addWithFilter(). */
+            counter_lines_parsed,
+            /** Records ended by their "=====" line. */
+            counter_records_completed,
+            /** Records ended by the timer in main.cpp, with no "=====" line. */
+            counter_records_forced,
+            /** Calls to Screen::paint() that drew a page. */
+            counter_paints,
+            /** Screen cells on the lines changed by those paints. */
+            counter_cells_touched,
+            counter_last
+        };
+
+        /**
+         * The timings.
+         */
+        enum timing_t
+        {
+            /** Time blocked in select() in Logfile::readLogfiles(). */
+            timing_select_wait,
+            /** Time in Components::addWithFilter(), less its pause. */
+            timing_parse_line,
+            /** Time in Screen::paint(), including refresh(). */
+            timing_paint,
+            timing_last
+        };
+
+        /**
+         * The stages a status record is traced through.
+         */
+        enum trace_stage_t
+        {
+            /** The first line of the record is read. */
+            trace_read,
+            /** The "=====" line is parsed, or the record is forced. */
+            trace_terminated,
+            /** Passed on to the feed, board, archive and headless clients. */
+            trace_published,
+            /** The screen is painted and refreshed. */
+            trace_painted,
+            trace_last
+        };
+
+        /**
+         * The record latencies, between the stages of a trace.
+         */
+        enum latency_t
+        {
+            /** From the time on the "NSS" line to trace_read. */
+            latency_source_to_read,
+            /** From trace_read to trace_terminated. */
+            latency_read_to_terminated,
+            /** From trace_terminated to trace_published. */
+            latency_terminated_to_published,
+            /** From trace_published to trace_painted. */
+            latency_published_to_painted,
+            /** From the time on the "NSS" line to trace_painted. */
+            latency_source_to_painted,
+            /** As latency_source_to_painted, for forced records only. */
+            latency_forced_source_to_painted,
+            latency_last
+        };
+
+        /** Constructor. Starts the clock calibration and catches SIGUSR1. */
+        Diagnostics();
+
+        /**
+         * Add to a counter.
+         *
+         * @param counter the counter.
+         * @param amount the amount to add.
+         */
+        static inline void count(counter_t counter, uint64_t amount = 1)
+        {
+            m_counters[counter] += amount;
+        }
+
+        /**
+         * Read the tick counter, the CPU time stamp counter where there
+         * is one, else the monotonic clock in nanoseconds.
+         *
+         * @return the ticks.
+         */
+        static inline uint64_t now()
+        {
+#if defined(__i386__) || defined(__x86_64__)
+            uint32_t low, high;
+            __asm__ __volatile__("rdtsc" : "=a"(low), "=d"(high));
+            return ((uint64_t)high << 32) | low;
+#else
+            return getNanoseconds();
+#endif
+        }
+
+        /**
+         * Record the time since a start taken with now().
+         *
+         * @param timing the timing.
+         * @param start the ticks at the start.
+         */
+        static inline void record(timing_t timing, uint64_t start)
+        {
+            m_timings[timing].record(now() - start);
+        }
+
+        /**
+         * Start tracing a record when its first line is read. Does
+         * nothing if a record is already being traced.
+         */
+        static void traceRead();
+
+        /**
+         * Set the time on the "NSS" line of the record being traced.
+         *
+         * @param sourceTime the UTC time, seconds since 1/1/70.
+         */
+        static void traceSource(time_t sourceTime);
+
+        /**
+         * Mark the record being traced as forced, ended by the timer
+         * in main.cpp rather than its "=====" line.
+         */
+        static inline void traceForced()
+        {
+            if(m_traceOpen) m_traceForced = true;
+        }
+
+        /**
+         * Mark a later stage of the record being traced.
+         *
+         * @param stage the stage, after trace_read.
+         */
+        static inline void traceStage(trace_stage_t stage)
+        {
+            if(m_traceOpen) m_traceTicks[stage] = now();
+        }
+
+        /**
+         * Finish the record being traced and record its latencies. A
+         * record that missed a stage or has no "NSS" time is dropped.
+         */
+        static void traceEnd();
+
+        /**
+         * Get the number of ticks per microsecond, measured over the
+         * run so far.
+         *
+         * @return the ticks per microsecond.
+         */
+        static double getTicksPerMicrosecond();
+
+        /**
+         * The SIGUSR1 handler. Asks for a dump.
+         *
+         * @param sig the signal.
+         */
+        static void dumpSignal(int sig);
+
+        /**
+         * Check if a dump has been asked for with SIGUSR1.
+         *
+         * @return true if a dump is wanted.
+         */
+        static bool isDumpRequested();
+
+        /**
+         * Append the counters and timings to a file.
+         *
+         * @param filename the file, e.g. DIAGNOSTICS_DUMP_FILE.
+         * @return true if written, else false.
+         */
+        bool dump(const string &filename);
+
+        /**
+         * Get the number of pages required to display all the information.
+         *
+         * @param pageRows the number of rows available on the screen.
+         * @return the number of pages required to display all the
+         * information.
+         */
+        int getNumPages(int pageRows);
+
+        /**
+         * Get the type of this object inherited from the Details class.
+         *
+         * @return the type as a detail_t enum value.
+         */
+        int getType();
+
+        /**
+         * Get the current page number displayed.
+         *
+         * @return the current page number displayed.
+         */
+        int getCurrentPageNumber();
+
+        /**
+         * Display the information on the screen.
+         *
+         * @param pageNum the page number to display.
+         * @param pageCols the number of columns on the screen.
+         * @param pageRows the number of rows on the screen.
+         * @return true if screen has changed, else false.
+         */
+        bool paint(int pageNum, int pageCols, int pageRows);
+
+    private:
+
+        /**
+         * Read the monotonic clock.
+         *
+         * @return the time in nanoseconds.
+         */
+        static uint64_t getNanoseconds();
+
+        /**
+         * Format the counters, timings and latencies as lines of text.
+         * The column headings are at DIAGNOSTICS_COUNTER_HEADING,
+         * DIAGNOSTICS_TIMING_HEADING and DIAGNOSTICS_LATENCY_HEADING.
+         *
+         * @param lines set to the lines.
+         */
+        void format(vector<string> &lines);
+
+        static uint64_t m_counters[counter_last];
+        static LatencyHistogram m_timings[timing_last];
+        static volatile sig_atomic_t m_dumpRequested;
+
+        /** The record latencies, in microseconds. */
+        static LatencyHistogram m_latencies[latency_last];
+
+        /** The records over DIAGNOSTICS_LATE_SECS. */
+        static uint64_t m_lateRecords;
+
+        /** True while a record is being traced. */
+        static bool m_traceOpen;
+
+        /** The ticks at each stage of the record, 0 if not reached. */
+        static uint64_t m_traceTicks[trace_last];
+
+        /** The time of trace_read, microseconds since 1/1/70. */
+        static uint64_t m_traceReadMicroseconds;
+
+        /** The time on the "NSS" line, 0 if not known. */
+        static time_t m_traceSource;
+
+        /** True if the record being traced is forced. */
+        static bool m_traceForced;
+
+        /** The ticks and clock when the calibration started. */
+        static uint64_t m_startTicks;
+        static uint64_t m_startNanoseconds;
+
+        /** The counters and clock at the start of the rate period. */
+        uint64_t m_rateCounters[counter_last];
+        uint64_t m_rateNanoseconds;
+
+        /** The rates per second over the last rate period. */
+        double m_rates[counter_last];
+};
+
+#endif //DIAGNOSTICS_H
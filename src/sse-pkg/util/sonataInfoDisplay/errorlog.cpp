@@ -0,0 +1,530 @@
+/*
+ * errorlog.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Reads and displays the error log.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file errorlog.cpp
+ * Reads and displays the error log.
+ */
+
+#include "errorlog.h"
+#include "componentstatus.h"
+#include "utils.h"
+#include <ncurses.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <strings.h>
+
+/** Rows above the table: time and title, filter, column headings. */
+#define ERRORLOG_HEADER_ROWS 3
+
+/** Only this many words after the time are searched for the fields. */
+#define ERRORLOG_HEADER_WORDS 6
+
+/*
+ * Constructor.
+ */
+ErrorLog::ErrorLog() : Details()
+{
+    m_thisType = detail_errors;
+    m_filterSeverity = -1;
+    m_filterSource = 0;
+    m_todayOnly = false;
+    m_from = 0;
+    m_lastRequestedPage = -1;
+}
+
+/*
+ * Add a line read from the error log.
+ *
+ * @param line the line.
+ * @return true if an entry was added or continued, else false.
+ */
+bool ErrorLog::addLine(const string &line)
+{
+    size_t end = line.find_last_not_of(" \t\r\n");
+    if(end == string::npos) return false;
+
+    ErrorEntry entry;
+    size_t utcOffset = 0;
+    time_t timestamp = ComponentStatus::parseTime(line, &utcOffset);
+
+    if(timestamp == 0)
+    {
+        //A continuation of the message before, so it reads as one.
+        size_t start = line.find_first_not_of(" \t");
+        string text = line.substr(start, end - start + 1);
+        if(!m_entries.empty())
+        {
+            ErrorEntry &last = m_entries.back();
+            last.text = m_strings.intern(m_strings.get(last.text) + " " + text);
+            return true;
+        }
+
+        //Only the end of a message made it into the file.
+        entry.timestamp = 0;
+        entry.code = 0;
+        entry.source = 0;
+        entry.severity = severity_error;
+        entry.text = m_strings.intern(text);
+    }
+    else
+    {
+        //Keep the times in order for the binary search.
+        entry.timestamp = (uint32_t)timestamp;
+        if(!m_entries.empty() && entry.timestamp < m_entries.back().timestamp)
+            entry.timestamp = m_entries.back().timestamp;
+
+        size_t pos = line.find_first_not_of(" \t", utcOffset + 4);
+        if(pos == string::npos || pos > end) pos = end + 1;
+        string text = line.substr(pos, end - pos + 1);
+
+        int severity = -1;
+        uint32_t code = 0;
+        string source = "";
+        bool afterSeverity = false;
+
+        //The message is what follows the fields found.
+        size_t messageStart = 0;
+
+        size_t wordStart = text.find_first_not_of(" \t");
+        for(int i = 0; i < ERRORLOG_HEADER_WORDS && wordStart != string::npos; i++)
+        {
+            size_t wordEnd = text.find_first_of(" \t", wordStart);
+            string word = text.substr(wordStart, (wordEnd == string::npos) ?
+                    string::npos : wordEnd - wordStart);
+            wordStart = (wordEnd == string::npos) ? string::npos :
+                text.find_first_not_of(" \t", wordEnd);
+
+            //Drop the punctuation around the word.
+            size_t first = word.find_first_not_of("[(<");
+            size_t last = word.find_last_not_of(":,;])>");
+            if(first == string::npos || last == string::npos || last < first) continue;
+            word = word.substr(first, last - first + 1);
+
+            bool wasAfterSeverity = afterSeverity;
+            afterSeverity = false;
+
+            if(severity < 0 && (severity = parseSeverity(word)) >= 0)
+            {
+                afterSeverity = true;
+            }
+            else if(code == 0 && (word == "code" || word == "Code") &&
+                    wordStart != string::npos)
+            {
+                code = (uint32_t)atol(text.c_str() + wordStart);
+                if(code == 0) continue;
+
+                //Skip the number too.
+                wordEnd = text.find_first_of(" \t", wordStart);
+                wordStart = (wordEnd == string::npos) ? string::npos :
+                    text.find_first_not_of(" \t", wordEnd);
+            }
+            else if(code == 0 && word[0] == '#' && word.size() > 1 && isdigit(word[1]))
+            {
+                code = (uint32_t)atol(word.c_str() + 1);
+            }
+            else if(code == 0 && wasAfterSeverity &&
+                    word.find_first_not_of("0123456789") == string::npos)
+            {
+                code = (uint32_t)atol(word.c_str());
+            }
+            else if(source == "" && isSourceName(word))
+            {
+                source = word;
+            }
+            else continue;
+
+            messageStart = (wordStart == string::npos) ? text.size() : wordStart;
+        }
+
+        entry.severity = (uint8_t)((severity < 0) ? severity_error : severity);
+        entry.code = code;
+        entry.source = m_strings.intern(source);
+        entry.text = m_strings.intern(text.substr(messageStart));
+    }
+
+    uint32_t index = (uint32_t)m_entries.size();
+    m_entries.push_back(entry);
+    m_bySeverity[entry.severity].push_back(index);
+    if(entry.source != 0) m_bySource[entry.source].push_back(index);
+
+    //A new day starts the today filter again.
+    if(m_todayOnly && entry.timestamp - entry.timestamp % 86400 != m_from)
+    {
+        updateSelection();
+    }
+    else if(matches(entry))
+    {
+        m_selection.push_back(index);
+    }
+
+    return true;
+}
+
+/*
+ * Check if a word names a component.
+ */
+bool ErrorLog::isSourceName(const string &word)
+{
+    if(word.empty() || word.size() >= 16) return false;
+    if(ComponentStatus::parseKind(word) != ComponentStatus::kind_unknown) return true;
+    if(strcasecmp(word.c_str(), "sse") == 0 || strcasecmp(word.c_str(), "nss") == 0)
+        return true;
+
+    //e.g. ifc1, tsig2
+    return isalpha(word[0]) && isdigit(word[word.size() - 1]);
+}
+
+/*
+ * Parse a severity word such as "Error:" or "SEVERITY_WARNING".
+ *
+ * @param word the word.
+ * @return the severity_t, -1 if the word is not a severity.
+ */
+int ErrorLog::parseSeverity(const string &word)
+{
+    const char *text = word.c_str();
+    if(strncasecmp(text, "SEVERITY_", 9) == 0) text += 9;
+
+    if(strcasecmp(text, "info") == 0) return severity_info;
+    if(strcasecmp(text, "warning") == 0 || strcasecmp(text, "warn") == 0)
+        return severity_warning;
+    if(strcasecmp(text, "error") == 0) return severity_error;
+    if(strcasecmp(text, "fatal") == 0) return severity_fatal;
+
+    return -1;
+}
+
+/*
+ * Get the name of a severity.
+ *
+ * @param severity the severity_t.
+ * @return the name.
+ */
+const char *ErrorLog::severityName(int severity)
+{
+    static const char *names[severity_last] = {
+        "Info", "Warning", "Error", "Fatal"
+    };
+
+    if(severity < 0 || severity >= severity_last) return "All";
+    return names[severity];
+}
+
+/*
+ * Find the first position in a list of entry indices with a time
+ * at or after a time.
+ */
+size_t ErrorLog::lowerBound(const vector<uint32_t> &list, time_t from) const
+{
+    size_t low = 0;
+    size_t high = list.size();
+
+    while(low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if((time_t)m_entries[list[mid]].timestamp < from) low = mid + 1;
+        else high = mid;
+    }
+
+    return low;
+}
+
+/*
+ * Select entries.
+ *
+ * @param severity the severity_t to select, -1 for all.
+ * @param source the component string id to select, 0 for all.
+ * @param from the earliest time to select, 0 for all.
+ * @param result set to the entry indices, oldest first.
+ */
+void ErrorLog::select(int severity, uint32_t source, time_t from,
+        vector<uint32_t> &result) const
+{
+    static const vector<uint32_t> none;
+    result.clear();
+
+    const vector<uint32_t> *bySeverity = NULL;
+    const vector<uint32_t> *bySource = NULL;
+
+    if(severity >= 0 && severity < severity_last) bySeverity = &m_bySeverity[severity];
+    if(source != 0)
+    {
+        map<uint32_t, vector<uint32_t> >::const_iterator it = m_bySource.find(source);
+        bySource = (it == m_bySource.end()) ? &none : &it->second;
+    }
+
+    if(bySeverity == NULL && bySource == NULL)
+    {
+        //Every entry, from the first at or after the time.
+        size_t low = 0;
+        size_t high = m_entries.size();
+        while(low < high)
+        {
+            size_t mid = low + (high - low) / 2;
+            if((time_t)m_entries[mid].timestamp < from) low = mid + 1;
+            else high = mid;
+        }
+        result.reserve(m_entries.size() - low);
+        for(size_t i = low; i < m_entries.size(); i++) result.push_back((uint32_t)i);
+        return;
+    }
+
+    //Walk the shorter list, checking the other filter on each entry.
+    const vector<uint32_t> *list = bySeverity;
+    if(list == NULL || (bySource != NULL && bySource->size() < list->size()))
+        list = bySource;
+
+    for(size_t i = lowerBound(*list, from); i < list->size(); i++)
+    {
+        const ErrorEntry &entry = m_entries[(*list)[i]];
+        if(severity >= 0 && entry.severity != severity) continue;
+        if(source != 0 && entry.source != source) continue;
+        result.push_back((*list)[i]);
+    }
+}
+
+/*
+ * Check if an entry passes the filter.
+ */
+bool ErrorLog::matches(const ErrorEntry &entry) const
+{
+    if(m_filterSeverity >= 0 && entry.severity != m_filterSeverity) return false;
+    if(m_filterSource != 0 && entry.source != m_filterSource) return false;
+    if(m_todayOnly && (time_t)entry.timestamp < m_from) return false;
+    return true;
+}
+
+/*
+ * Select the entries that pass the filter again.
+ */
+void ErrorLog::updateSelection()
+{
+    m_from = 0;
+    if(m_todayOnly && !m_entries.empty())
+        m_from = m_entries.back().timestamp - m_entries.back().timestamp % 86400;
+
+    select(m_filterSeverity, m_filterSource, m_from, m_selection);
+}
+
+/*
+ * Get the number of entries.
+ *
+ * @return the number of entries.
+ */
+uint32_t ErrorLog::size() const
+{
+    return (uint32_t)m_entries.size();
+}
+
+/*
+ * Get an entry.
+ *
+ * @param index the entry index, from 0 to size()-1.
+ * @return the entry.
+ */
+const ErrorEntry &ErrorLog::getEntry(uint32_t index) const
+{
+    return m_entries[index];
+}
+
+/*
+ * Get the strings the entries refer to.
+ *
+ * @return the string pool.
+ */
+const StringPool &ErrorLog::getStrings() const
+{
+    return m_strings;
+}
+
+/*
+ * Display the information on the screen. Newest first.
+ *
+ * @param pageNum the page number to display.
+ * @param pageCols the number of columns on the screen.
+ * @param pageRows the number of rows on the screen.
+ * @return true if screen has changed, else false.
+ */
+bool ErrorLog::paint(int pageNum, int pageCols, int pageRows)
+{
+    char tempLine[256];
+    string blank(pageCols, ' ');
+    string line;
+
+    if(pageNum > getNumPages(pageRows)) pageNum = getNumPages(pageRows);
+    m_lastRequestedPage = pageNum;
+
+    //Draw the header
+    string headerString = "SonATA Error Log";
+    move(0,0);
+    addstr(blank.c_str());
+    move(0,0);
+    if(!m_entries.empty())
+    {
+        time_t newest = m_entries.back().timestamp;
+        struct tm t;
+        gmtime_r(&newest, &t);
+        strftime(tempLine, sizeof(tempLine), "%H:%M:%S UTC", &t);
+        addstr(tempLine);
+    }
+    Utils::drawColorText(0, pageCols/2 - headerString.size()/2, 3, headerString);
+
+    const string &source = m_strings.get(m_filterSource);
+    snprintf(tempLine, sizeof(tempLine),
+            "%u of %u. s=Severity: %s, c=Component: %s, t=Days: %s",
+            (unsigned int)m_selection.size(), (unsigned int)m_entries.size(),
+            severityName(m_filterSeverity),
+            (m_filterSource == 0) ? "All" : source.c_str(),
+            m_todayOnly ? "Today" : "All");
+    line = tempLine;
+    line.resize(pageCols, ' ');
+    move(1,0);
+    addstr(line.c_str());
+
+    snprintf(tempLine, sizeof(tempLine), "%-14s %-7s %-8s %6s  %s",
+            "Time", "Sev", "From", "Code", "Message");
+    line = tempLine;
+    line.resize(pageCols, ' ');
+    Utils::drawColorText(2, 0, 2, line);
+
+    int realRows = pageRows - ERRORLOG_HEADER_ROWS;
+    int startIndex = (pageNum-1) * realRows;
+
+    for(int i = 0; i < realRows; i++)
+    {
+        int index = startIndex + i;
+        int row = ERRORLOG_HEADER_ROWS + i;
+
+        move(row, 0);
+        addstr(blank.c_str());
+        if(index >= (int)m_selection.size()) continue;
+
+        const ErrorEntry &entry = m_entries[m_selection[m_selection.size() - 1 - index]];
+
+        char timeText[32] = "";
+        time_t timestamp = entry.timestamp;
+        struct tm t;
+        if(timestamp > 0)
+        {
+            gmtime_r(&timestamp, &t);
+            strftime(timeText, sizeof(timeText), "%m-%d %H:%M:%S", &t);
+        }
+        string code = (entry.code == 0) ? "" : Utils::itos((unsigned int)entry.code);
+
+        snprintf(tempLine, sizeof(tempLine), "%-14s %-7s %-8s %6s  ",
+                timeText, severityName(entry.severity),
+                m_strings.get(entry.source).c_str(), code.c_str());
+
+        int color = 0;
+        if(entry.severity >= severity_error) color = 1;
+        else if(entry.severity == severity_warning) color = 3;
+        Utils::drawColorText(row, 0, color, tempLine);
+
+        //The message is drawn straight from the pool, cut at the edge.
+        const string &text = m_strings.get(entry.text);
+        int room = pageCols - (int)strlen(tempLine);
+        if(room > 0) addnstr(text.c_str(), room);
+    }
+
+    //Park the cursor in the lower right corner
+    move(pageRows-1, pageCols-1);
+
+    return true;
+}
+
+/*
+ * Handle a key press to change the filter.
+ *
+ * @param ch the key, as returned by getch().
+ * @return true if the screen should be repainted, else false.
+ */
+bool ErrorLog::processKey(int ch)
+{
+    if(ch == 's')
+    {
+        m_filterSeverity++;
+        if(m_filterSeverity >= severity_last) m_filterSeverity = -1;
+    }
+    else if(ch == 'c')
+    {
+        //The next component that has entries, then all.
+        map<uint32_t, vector<uint32_t> >::const_iterator it =
+            m_bySource.upper_bound(m_filterSource);
+        m_filterSource = (it == m_bySource.end()) ? 0 : it->first;
+    }
+    else if(ch == 't')
+    {
+        m_todayOnly = !m_todayOnly;
+    }
+    else return false;
+
+    updateSelection();
+    return true;
+}
+
+/*
+ * Get the number of pages required to display all the information.
+ *
+ * @param pageRows the number of rows available on the screen.
+ * @return the number of pages required to display all the
+ * information.
+ */
+int ErrorLog::getNumPages(int pageRows)
+{
+    int realRows = pageRows - ERRORLOG_HEADER_ROWS;
+    if(realRows < 1) return 1;
+
+    int rows = (int)m_selection.size();
+    if(rows < 1) return 1;
+    return (rows - 1) / realRows + 1;
+}
+
+/*
+ * Get the type of this object inherited from the Details class.
+ *
+ * @return the type as a detail_t enum value.
+ */
+int ErrorLog::getType()
+{
+    return m_thisType;
+}
+
+/*
+ * Get the current page number displayed.
+ *
+ * @return the current page number displayed.
+ */
+int ErrorLog::getCurrentPageNumber()
+{
+    if(m_lastRequestedPage <= 0) return 1;
+    return m_lastRequestedPage;
+}
@@ -0,0 +1,246 @@
+/*
+ * errorlog.h
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Reads and displays the error log.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file errorlog.h
+ * Reads and displays the error log.
+ */
+
+#ifndef ERRORLOG_H
+#define ERRORLOG_H
+
+#include "details.h"
+#include "stringpool.h"
+#include <map>
+
+using namespace std;
+
+/**
+ * One message from the error log. The strings are ids in the
+ * ErrorLog string pool.
+ */
+struct ErrorEntry
+{
+    /** The UTC time of the message, seconds since 1/1/70. */
+    uint32_t timestamp;
+    /** The message code, 0 if none. */
+    uint32_t code;
+    /** The component that reported it, "" if not known. */
+    uint32_t source;
+    /** The message text. */
+    uint32_t text;
+    /** An ErrorLog::severity_t value. */
+    uint8_t severity;
+};
+
+/**
+ * Reads "errorlog-YYYY-MM-DD.txt" and displays it filtered by severity,
+ * component and day.
+ *
+ * Each line is parsed into its time (the "YYYY-MM-DD HH:MM:SS UTC"
+ * stamp), severity (the first Info, Warning, Error or Fatal word, Error
+ * if there is none), the component that reported it (the first word
+ * such as "dx1003" or "ifc1"), a code ("code N", "#N" or a number
+ * straight after the severity) and the message text that follows
+ * them. A line without a time stamp is appended to the message before
+ * it, so a message of several lines is one entry. The strings are kept
+ * in a StringPool, so an entry is 20 bytes however long the message.
+ *
+ * Entries are only ever appended. Each entry is also added to a list
+ * for its severity and one for its component, so selecting all the
+ * errors from dx1003 walks the shorter of two lists rather than the
+ * whole log, and a day is found with a binary search on time.
+ *
+ * Keys: 's' cycles the severity shown, 'c' the component and 't'
+ * switches between today and all days.
+ *
+ * Inherits from the Details class.
+ */
+class ErrorLog: public Details
+{
+    public:
+
+        /**
+         * The severities. The values match NssMessageSeverity in
+         * sseInterface.h.
+         */
+        enum severity_t
+        {
+            severity_info,
+            severity_warning,
+            severity_error,
+            severity_fatal,
+            severity_last
+        };
+
+        /** Constructor. */
+        ErrorLog();
+
+        /**
+         * Add a line read from the error log.
+         *
+         * @param line the line.
+         * @return true if an entry was added or continued, else false.
+         */
+        bool addLine(const string &line);
+
+        /**
+         * Select entries.
+         *
+         * @param severity the severity_t to select, -1 for all.
+         * @param source the component string id to select, 0 for all.
+         * @param from the earliest time to select, 0 for all.
+         * @param result set to the entry indices, oldest first.
+         */
+        void select(int severity, uint32_t source, time_t from,
+                vector<uint32_t> &result) const;
+
+        /**
+         * Get the number of entries.
+         *
+         * @return the number of entries.
+         */
+        uint32_t size() const;
+
+        /**
+         * Get an entry.
+         *
+         * @param index the entry index, from 0 to size()-1.
+         * @return the entry.
+         */
+        const ErrorEntry &getEntry(uint32_t index) const;
+
+        /**
+         * Get the strings the entries refer to.
+         *
+         * @return the string pool.
+         */
+        const StringPool &getStrings() const;
+
+        /**
+         * Parse a severity word such as "Error:" or "SEVERITY_WARNING".
+         *
+         * @param word the word.
+         * @return the severity_t, -1 if the word is not a severity.
+         */
+        static int parseSeverity(const string &word);
+
+        /**
+         * Get the name of a severity.
+         *
+         * @param severity the severity_t.
+         * @return the name.
+         */
+        static const char *severityName(int severity);
+
+        /**
+         * Get the number of pages required to display all the information.
+         *
+         * @param pageRows the number of rows available on the screen.
+         * @return the number of pages required to display all the
+         * information.
+         */
+        int getNumPages(int pageRows);
+
+        /**
+         * Get the type of this object inherited from the Details class.
+         *
+         * @return the type as a detail_t enum value.
+         */
+        int getType();
+
+        /**
+         * Get the current page number displayed.
+         *
+         * @return the current page number displayed.
+         */
+        int getCurrentPageNumber();
+
+        /**
+         * Display the information on the screen. Newest first.
+         *
+         * @param pageNum the page number to display.
+         * @param pageCols the number of columns on the screen.
+         * @param pageRows the number of rows on the screen.
+         * @return true if screen has changed, else false.
+         */
+        bool paint(int pageNum, int pageCols, int pageRows);
+
+        /**
+         * Handle a key press to change the filter.
+         *
+         * @param ch the key, as returned by getch().
+         * @return true if the screen should be repainted, else false.
+         */
+        bool processKey(int ch);
+
+    private:
+
+        /**
+         * Check if a word names a component.
+         */
+        static bool isSourceName(const string &word);
+
+        /**
+         * Find the first position in a list of entry indices with a time
+         * at or after a time.
+         */
+        size_t lowerBound(const vector<uint32_t> &list, time_t from) const;
+
+        /**
+         * Check if an entry passes the filter.
+         */
+        bool matches(const ErrorEntry &entry) const;
+
+        /**
+         * Select the entries that pass the filter again.
+         */
+        void updateSelection();
+
+        vector<ErrorEntry> m_entries;
+        StringPool m_strings;
+
+        /** Entry indices by severity and by component string id. */
+        vector<uint32_t> m_bySeverity[severity_last];
+        map<uint32_t, vector<uint32_t> > m_bySource;
+
+        /** The filter: a severity_t or -1, a string id or 0, today only. */
+        int m_filterSeverity;
+        uint32_t m_filterSource;
+        bool m_todayOnly;
+        time_t m_from;
+
+        /** The entries that pass the filter, oldest first. */
+        vector<uint32_t> m_selection;
+
+        int m_lastRequestedPage;
+};
+
+#endif //ERRORLOG_H
+
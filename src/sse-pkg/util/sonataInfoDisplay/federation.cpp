@@ -0,0 +1,266 @@
+/*
+ * federation.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Merges the status of several SonATA sites into one display.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file federation.cpp
+ * Merges the status of several SonATA sites into one display.
+ */
+
+#include "federation.h"
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* Constructor. */
+Federation::Federation()
+{
+    m_changed = false;
+}
+
+/* Destructor. Closes the sites. */
+Federation::~Federation()
+{
+    for(int i = 0; i < (int)m_sites.size(); i++)
+        if(m_sites[i].fd >= 0) close(m_sites[i].fd);
+}
+
+/*
+ * Add a site. The site is reached on the next poll().
+ *
+ * @param name the site name, used as the component name prefix.
+ * @param path the UNIX socket or status feed file of the site.
+ * @return false if the name is empty, longer than
+ * FEDERATION_MAX_SITE_NAME or already used.
+ */
+bool Federation::addSite(const string &name, const string &path)
+{
+    if(name == "" || path == "" || name.size() > FEDERATION_MAX_SITE_NAME) return false;
+    for(int i = 0; i < (int)m_sites.size(); i++)
+        if(m_sites[i].name == name) return false;
+
+    Site site;
+    site.name = name;
+    site.path = path;
+    site.fd = -1;
+    site.socket = false;
+    site.lastAttempt = 0;
+    m_sites.push_back(site);
+
+    return true;
+}
+
+/*
+ * Get the number of sites.
+ *
+ * @return the number of sites added.
+ */
+int Federation::getSiteCount() const
+{
+    return (int)m_sites.size();
+}
+
+/*
+ * Read whatever the sites have sent, without waiting, and
+ * reconnect to the sites that have gone.
+ *
+ * @param header set to the merged record header if there are
+ * changes. The time is that of the latest site.
+ * @param record set to the merged components of all the sites
+ * if there are changes.
+ * @return true if any component changed, else false and the
+ * header and record are left alone.
+ */
+bool Federation::poll(StatusFeedHeader &header, vector<ComponentStatus> &record)
+{
+    time_t now = time(NULL);
+
+    for(int i = 0; i < (int)m_sites.size(); i++)
+    {
+        Site &site = m_sites[i];
+        if(site.fd < 0)
+        {
+            if(now - site.lastAttempt < FEDERATION_RETRY_SECONDS) continue;
+            site.lastAttempt = now;
+            if(!connect(site)) continue;
+        }
+        if(read(site)) m_changed = true;
+    }
+
+    if(!m_changed) return false;
+    m_changed = false;
+
+    //The activity is only meaningful for a single site.
+    header = StatusFeedHeader();
+    header.activityId = (m_sites.size() == 1) ? m_sites[0].header.activityId : -1;
+    for(int i = 0; i < (int)m_sites.size(); i++)
+    {
+        const StatusFeedHeader &siteHeader = m_sites[i].header;
+        if(siteHeader.timestamp > header.timestamp) header.timestamp = siteHeader.timestamp;
+        if(siteHeader.maxDxFreqMHz <= 0) continue;
+        if(header.maxDxFreqMHz <= 0 || siteHeader.minDxFreqMHz < header.minDxFreqMHz)
+            header.minDxFreqMHz = siteHeader.minDxFreqMHz;
+        if(siteHeader.maxDxFreqMHz > header.maxDxFreqMHz)
+            header.maxDxFreqMHz = siteHeader.maxDxFreqMHz;
+    }
+    if(header.timestamp == 0) header.timestamp = (int32_t)now;
+
+    record.clear();
+    map<string, ComponentStatus>::iterator it;
+    for(it = m_components.begin(); it != m_components.end(); it++)
+        record.push_back(it->second);
+
+    return true;
+}
+
+/*
+ * Open the socket or file of a site.
+ *
+ * @param site the site.
+ * @return true if connected, else false.
+ */
+bool Federation::connect(Site &site)
+{
+    struct stat info;
+
+    if(stat(site.path.c_str(), &info) < 0) return false;
+    site.socket = S_ISSOCK(info.st_mode);
+
+    if(site.socket)
+    {
+        struct sockaddr_un address;
+        if(site.path.size() >= sizeof(address.sun_path)) return false;
+
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strcpy(address.sun_path, site.path.c_str());
+
+        site.fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if(site.fd < 0) return false;
+        if(::connect(site.fd, (struct sockaddr *)&address, sizeof(address)) < 0)
+        {
+            close(site.fd);
+            site.fd = -1;
+            return false;
+        }
+    }
+    else
+    {
+        //A file is read from the start, it may hold only changes.
+        site.fd = open(site.path.c_str(), O_RDONLY);
+        if(site.fd < 0) return false;
+    }
+
+    fcntl(site.fd, F_SETFL, fcntl(site.fd, F_GETFL) | O_NONBLOCK);
+    site.buffer.clear();
+
+    return true;
+}
+
+/*
+ * Close a site and mark its components "Unknown".
+ *
+ * @param site the site.
+ */
+void Federation::disconnect(Site &site)
+{
+    close(site.fd);
+    site.fd = -1;
+    site.buffer.clear();
+
+    //Its components follow the site name and ':' in the map.
+    string prefix = site.name + ":";
+    map<string, ComponentStatus>::iterator it = m_components.lower_bound(prefix);
+    for(; it != m_components.end() && it->first.compare(0, prefix.size(), prefix) == 0; it++)
+    {
+        if(it->second.state == ComponentStatus::state_unknown) continue;
+        it->second.state = ComponentStatus::state_unknown;
+        m_changed = true;
+    }
+}
+
+/*
+ * Read and apply the records a site has sent.
+ *
+ * @param site the site.
+ * @return true if any component changed.
+ */
+bool Federation::read(Site &site)
+{
+    char data[8192];
+    bool changed = false;
+
+    while(1)
+    {
+        ssize_t count = ::read(site.fd, data, sizeof(data));
+        if(count < 0 && errno == EINTR) continue;
+        if(count < 0 && errno == EAGAIN) break;
+        if(count < 0 || (count == 0 && site.socket))
+        {
+            disconnect(site);
+            return changed;
+        }
+        if(count == 0) break;
+        site.buffer.append(data, count);
+    }
+
+    //Each record holds the components that changed at the site.
+    size_t offset = 0;
+    while(offset < site.buffer.size())
+    {
+        int used = StatusFeed::decode(site.buffer.data() + offset,
+                (int)(site.buffer.size() - offset), site.header, m_record);
+        if(used == 0) break;
+        if(used < 0)
+        {
+            //Not a record, skip to the next one.
+            size_t next = site.buffer.find(STATUS_FEED_MAGIC, offset + 1);
+            offset = (next == string::npos) ? site.buffer.size() : next;
+            continue;
+        }
+        offset += used;
+
+        for(int i = 0; i < (int)m_record.size(); i++)
+        {
+            const char *siteName = m_record[i].name;
+            string name = site.name + ":" +
+                string(siteName, strnlen(siteName, ComponentStatus::MAX_NAME));
+            ComponentStatus &status = m_components[name];
+            status = m_record[i];
+            status.setName(name);
+            changed = true;
+        }
+    }
+    site.buffer.erase(0, offset);
+
+    return changed;
+}
@@ -0,0 +1,168 @@
+/*
+ * federation.h
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Merges the status of several SonATA sites into one display.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file federation.h
+ * Merges the status of several SonATA sites into one display.
+ */
+
+#ifndef FEDERATION_H
+#define FEDERATION_H
+
+#include "statusfeed.h"
+#include <time.h>
+#include <map>
+
+using namespace std;
+
+/** Seconds between attempts to reach a site that is not connected. */
+#define FEDERATION_RETRY_SECONDS 5
+
+/** The longest site name, so that "site:" and a component name such as
+ * "dx1000" fit in ComponentStatus::MAX_NAME-1 characters. */
+#define FEDERATION_MAX_SITE_NAME 4
+
+/**
+ * Merges the status of several SonATA sites (e.g. the ATA, Arecibo and
+ * Jodrell Bank) into one record for a combined display.
+ *
+ * Each site is read from a binary status feed, either the UNIX socket of
+ * a headless instance run with "-H binary -S path" or a file written
+ * with "-b" or "-H binary". A headless instance sends only the
+ * components that change (see StatusDelta), so the traffic from a site
+ * follows its rate of change rather than its number of components. The
+ * last state of every component of every site is kept here, and a
+ * merged record is built only when one of them changes.
+ *
+ * In the merged record each component is named after its site, as in
+ * "ata:dx1000". Site names are kept to FEDERATION_MAX_SITE_NAME
+ * characters, as the names of the components of two sites must still
+ * differ once ComponentStatus has cut them to MAX_NAME-1. The components
+ * of a site that goes away are shown as "Unknown" until it is back.
+ */
+class Federation
+{
+    public:
+
+        /** Constructor. */
+        Federation();
+
+        /** Destructor. Closes the sites. */
+        ~Federation();
+
+        /**
+         * Add a site. The site is reached on the next poll().
+         *
+         * @param name the site name, used as the component name prefix.
+         * @param path the UNIX socket or status feed file of the site.
+         * @return false if the name is empty, longer than
+         * FEDERATION_MAX_SITE_NAME or already used.
+         */
+        bool addSite(const string &name, const string &path);
+
+        /**
+         * Get the number of sites.
+         *
+         * @return the number of sites added.
+         */
+        int getSiteCount() const;
+
+        /**
+         * Read whatever the sites have sent, without waiting, and
+         * reconnect to the sites that have gone.
+         *
+         * @param header set to the merged record header if there are
+         * changes. The time is that of the latest site.
+         * @param record set to the merged components of all the sites
+         * if there are changes.
+         * @return true if any component changed, else false and the
+         * header and record are left alone.
+         */
+        bool poll(StatusFeedHeader &header, vector<ComponentStatus> &record);
+
+    private:
+
+        /**
+         * One site being merged.
+         */
+        struct Site
+        {
+            /** The site name. */
+            string name;
+            /** The UNIX socket or status feed file. */
+            string path;
+            /** The open socket or file, -1 if not connected. */
+            int fd;
+            /** True if path is a socket, else a file. */
+            bool socket;
+            /** The bytes read that are not yet a whole record. */
+            string buffer;
+            /** The header of the last record from the site. */
+            StatusFeedHeader header;
+            /** The time of the last attempt to connect. */
+            time_t lastAttempt;
+        };
+
+        /**
+         * Open the socket or file of a site.
+         *
+         * @param site the site.
+         * @return true if connected, else false.
+         */
+        bool connect(Site &site);
+
+        /**
+         * Close a site and mark its components "Unknown".
+         *
+         * @param site the site.
+         */
+        void disconnect(Site &site);
+
+        /**
+         * Read and apply the records a site has sent.
+         *
+         * @param site the site.
+         * @return true if any component changed.
+         */
+        bool read(Site &site);
+
+        /** The sites. */
+        vector<Site> m_sites;
+
+        /** The last state of every component, keyed by "site:name". */
+        map<string, ComponentStatus> m_components;
+
+        /** Reused for decoding so polling does not allocate. */
+        vector<ComponentStatus> m_record;
+
+        /** True if a component changed since the last merged record. */
+        bool m_changed;
+};
+
+#endif //FEDERATION_H
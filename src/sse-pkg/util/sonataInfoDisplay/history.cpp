@@ -0,0 +1,276 @@
+/*
+ * history.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Displays the state of the components at a past time.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file history.cpp
+ * Displays the state of the components at a past time.
+ */
+
+#include "history.h"
+#include "utils.h"
+#include <ncurses.h>
+#include <stdio.h>
+
+/** Rows above the table: time and title, position, column headings. */
+#define HISTORY_HEADER_ROWS 3
+
+/** Seconds moved by the '[' and ']' keys. */
+#define HISTORY_STEP_SECS 600
+
+/*
+ * Constructor.
+ */
+History::History() : Details()
+{
+    m_thisType = detail_history;
+    m_cursor = 0;
+    m_lastRequestedPage = -1;
+}
+
+/*
+ * Add the state changes in a complete status record.
+ *
+ * @param recordTime the UTC time of the record.
+ * @param record the parsed components of the record.
+ */
+void History::addRecord(time_t recordTime, const vector<ComponentStatus> &record)
+{
+    m_ring.addRecord(recordTime, record);
+}
+
+/*
+ * Get the history of state changes.
+ *
+ * @return the history.
+ */
+const HistoryRing &History::getRing() const
+{
+    return m_ring;
+}
+
+/*
+ * Display the information on the screen.
+ *
+ * @param pageNum the page number to display.
+ * @param pageCols the number of columns on the screen.
+ * @param pageRows the number of rows on the screen.
+ * @return true if screen has changed, else false.
+ */
+bool History::paint(int pageNum, int pageCols, int pageRows)
+{
+    char tempLine[256];
+    char timeText[64];
+    string blank(pageCols, ' ');
+    string line;
+
+    if(pageNum > getNumPages(pageRows)) pageNum = getNumPages(pageRows);
+    m_lastRequestedPage = pageNum;
+
+    time_t newest = m_ring.getNewestTime();
+    time_t shown = (m_cursor == 0) ? newest : m_cursor;
+    struct tm t;
+
+    //Draw the header
+    string headerString = "SonATA State History";
+    move(0,0);
+    addstr(blank.c_str());
+    move(0,0);
+    if(newest > 0)
+    {
+        gmtime_r(&newest, &t);
+        strftime(tempLine, sizeof(tempLine), "%H:%M:%S UTC", &t);
+        addstr(tempLine);
+    }
+    Utils::drawColorText(0, pageCols/2 - headerString.size()/2, 3, headerString);
+
+    //Where in time the display is.
+    gmtime_r(&shown, &t);
+    strftime(timeText, sizeof(timeText), "%Y-%m-%d %H:%M:%S UTC", &t);
+    if(m_cursor == 0)
+    {
+        snprintf(tempLine, sizeof(tempLine),
+                "Live at %s. <-/-> = change, [/] = 10 min", timeText);
+    }
+    else
+    {
+        long ago = (long)(newest - m_cursor);
+        snprintf(tempLine, sizeof(tempLine),
+                "At %s, %ld:%02ld:%02ld ago. <-/-> = change, [/] = 10 min, l=live",
+                timeText, ago / 3600, (ago / 60) % 60, ago % 60);
+    }
+    line = tempLine;
+    line.resize(pageCols, ' ');
+    move(1,0);
+    if(m_cursor == 0) addstr(line.c_str());
+    else Utils::drawColorText(1, 0, 3, line);
+
+    snprintf(tempLine, sizeof(tempLine), "%-10s %-16s %6s  %-16s",
+            "Component", "State", "Act", "Now");
+    line = tempLine;
+    line.resize(pageCols, ' ');
+    Utils::drawColorText(2, 0, 2, line);
+
+    bool known = m_ring.getStateAt(shown, m_states, m_activities);
+    const HistoryRing &ring = m_ring;
+
+    int realRows = pageRows - HISTORY_HEADER_ROWS;
+    int startIndex = (pageNum-1) * realRows;
+    vector<uint8_t> now;
+    vector<int32_t> nowActivities;
+    if(m_cursor != 0) ring.getStateAt(newest, now, nowActivities);
+
+    for(int i = 0; i < realRows; i++)
+    {
+        int id = startIndex + i;
+        int row = HISTORY_HEADER_ROWS + i;
+
+        if(id >= ring.getComponentCount() || !known)
+        {
+            move(row, 0);
+            addstr(blank.c_str());
+            if(i == 0 && !known)
+                Utils::drawColorText(row, 0, 1, "Older than the history kept.");
+            continue;
+        }
+
+        int state = (id < (int)m_states.size()) ? (int)m_states[id] :
+            (int)ComponentStatus::state_unknown;
+        string activity = "-";
+        if(id < (int)m_activities.size() && m_activities[id] >= 0)
+            activity = Utils::itos((int)m_activities[id]);
+
+        //Show the state now only when it has changed since.
+        string nowState = "";
+        if(m_cursor != 0 && id < (int)now.size() && now[id] != state)
+            nowState = ComponentStatus::stateName(now[id]);
+
+        snprintf(tempLine, sizeof(tempLine), "%-10s %-16s %6s  %-16s",
+                ring.getComponentName(id).c_str(),
+                ComponentStatus::stateName(state), activity.c_str(),
+                nowState.c_str());
+        line = tempLine;
+        line.resize(pageCols, ' ');
+
+        if(state == ComponentStatus::state_offline ||
+                state == ComponentStatus::state_error)
+            Utils::drawColorText(row, 0, 1, line);
+        else
+        {
+            move(row, 0);
+            addstr(line.c_str());
+        }
+    }
+
+    //Park the cursor in the lower right corner
+    move(pageRows-1, pageCols-1);
+
+    return true;
+}
+
+/*
+ * Handle a key press to move through time.
+ *
+ * @param ch the key, as returned by getch().
+ * @return true if the screen should be repainted, else false.
+ */
+bool History::processKey(int ch)
+{
+    time_t newest = m_ring.getNewestTime();
+    time_t oldest = m_ring.getOldestTime();
+    time_t shown = (m_cursor == 0) ? newest : m_cursor;
+    time_t next = 0;
+
+    if(newest == 0) return false;
+
+    if(ch == KEY_LEFT)
+    {
+        next = m_ring.getPreviousTime(shown);
+        if(next == 0) return false;
+    }
+    else if(ch == KEY_RIGHT)
+    {
+        next = m_ring.getNextTime(shown);
+        if(next == 0) next = newest;
+    }
+    else if(ch == '[')
+    {
+        next = shown - HISTORY_STEP_SECS;
+        if(next < oldest) next = oldest;
+    }
+    else if(ch == ']')
+    {
+        next = shown + HISTORY_STEP_SECS;
+    }
+    else if(ch == 'l')
+    {
+        next = newest;
+    }
+    else return false;
+
+    m_cursor = (next >= newest) ? 0 : next;
+    return true;
+}
+
+/*
+ * Get the number of pages required to display all the information.
+ *
+ * @param pageRows the number of rows available on the screen.
+ * @return the number of pages required to display all the
+ * information.
+ */
+int History::getNumPages(int pageRows)
+{
+    int realRows = pageRows - HISTORY_HEADER_ROWS;
+    if(realRows < 1) return 1;
+
+    int rows = m_ring.getComponentCount();
+    if(rows < 1) return 1;
+    return (rows - 1) / realRows + 1;
+}
+
+/*
+ * Get the type of this object inherited from the Details class.
+ *
+ * @return the type as a detail_t enum value.
+ */
+int History::getType()
+{
+    return m_thisType;
+}
+
+/*
+ * Get the current page number displayed.
+ *
+ * @return the current page number displayed.
+ */
+int History::getCurrentPageNumber()
+{
+    if(m_lastRequestedPage <= 0) return 1;
+    return m_lastRequestedPage;
+}
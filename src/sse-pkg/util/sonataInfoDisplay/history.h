@@ -0,0 +1,132 @@
+/*
+ * history.h
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Displays the state of the components at a past time.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file history.h
+ * Displays the state of the components at a past time.
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "details.h"
+#include "historyring.h"
+
+using namespace std;
+
+/**
+ * Displays the state of the components at any time still held in a
+ * HistoryRing, e.g. to see which dx dropped offline at 3 a.m. and for
+ * how long.
+ *
+ * The display follows the latest record until it is moved back with
+ * the left arrow (to the previous state change) or '[' (10 minutes).
+ * The right arrow and ']' move forward, and 'l' goes back to live.
+ *
+ * Inherits from the Details class.
+ */
+class History: public Details
+{
+    public:
+
+        /** Constructor. */
+        History();
+
+        /**
+         * Add the state changes in a complete status record.
+         *
+         * @param recordTime the UTC time of the record.
+         * @param record the parsed components of the record.
+         */
+        void addRecord(time_t recordTime, const vector<ComponentStatus> &record);
+
+        /**
+         * Get the history of state changes.
+         *
+         * @return the history.
+         */
+        const HistoryRing &getRing() const;
+
+        /**
+         * Get the number of pages required to display all the information.
+         *
+         * @param pageRows the number of rows available on the screen.
+         * @return the number of pages required to display all the
+         * information.
+         */
+        int getNumPages(int pageRows);
+
+        /**
+         * Get the type of this object inherited from the Details class.
+         *
+         * @return the type as a detail_t enum value.
+         */
+        int getType();
+
+        /**
+         * Get the current page number displayed.
+         *
+         * @return the current page number displayed.
+         */
+        int getCurrentPageNumber();
+
+        /**
+         * Display the information on the screen.
+         *
+         * @param pageNum the page number to display.
+         * @param pageCols the number of columns on the screen.
+         * @param pageRows the number of rows on the screen.
+         * @return true if screen has changed, else false.
+         */
+        bool paint(int pageNum, int pageCols, int pageRows);
+
+        /**
+         * Handle a key press to move through time.
+         *
+         * @param ch the key, as returned by getch().
+         * @return true if the screen should be repainted, else false.
+         */
+        bool processKey(int ch);
+
+    private:
+
+        HistoryRing m_ring;
+
+        /** The time displayed, 0 to follow the latest record. */
+        time_t m_cursor;
+
+        int m_lastRequestedPage;
+
+        /** The state at the time displayed, reused for each paint. */
+        vector<uint8_t> m_states;
+        vector<int32_t> m_activities;
+};
+
+#endif //HISTORY_H
+
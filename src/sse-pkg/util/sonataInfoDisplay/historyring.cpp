@@ -0,0 +1,298 @@
+/*
+ * historyring.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * A fixed size history of component state changes.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file historyring.cpp
+ * A fixed size history of component state changes.
+ */
+
+#include "historyring.h"
+
+/*
+ * Constructor.
+ *
+ * @param capacity the number of changes to keep. Rounded up to
+ * a multiple of HISTORY_KEYFRAME_INTERVAL.
+ */
+HistoryRing::HistoryRing(int capacity)
+{
+    int keyframes = (capacity + HISTORY_KEYFRAME_INTERVAL - 1) / HISTORY_KEYFRAME_INTERVAL;
+    if(keyframes < 1) keyframes = 1;
+
+    m_capacity = keyframes * HISTORY_KEYFRAME_INTERVAL;
+    m_ring.resize(m_capacity);
+    m_keyframes.resize(keyframes);
+    m_next = 0;
+    m_newestTime = 0;
+}
+
+/*
+ * Add the changes in a complete status record.
+ *
+ * @param recordTime the UTC time of the record.
+ * @param record the parsed components of the record.
+ */
+void HistoryRing::addRecord(time_t recordTime, const vector<ComponentStatus> &record)
+{
+    //Keep the times in order for the binary search, even if the
+    //clock steps back.
+    uint32_t timestamp = (uint32_t)recordTime;
+    if(timestamp < m_newestTime) timestamp = m_newestTime;
+    m_newestTime = timestamp;
+
+    for(int i = 0; i < (int)record.size(); i++)
+    {
+        int id = getComponentId(record[i].name);
+        if(id < 0) continue;
+        if(m_states[id] != record[i].state || m_activities[id] != record[i].activityId)
+            addTransition(timestamp, id, record[i].state, record[i].activityId);
+    }
+}
+
+/*
+ * Add one change.
+ */
+void HistoryRing::addTransition(uint32_t timestamp, int id, int newState,
+        int32_t activityId)
+{
+    if(m_next % HISTORY_KEYFRAME_INTERVAL == 0)
+    {
+        Keyframe &keyframe = m_keyframes[(m_next / HISTORY_KEYFRAME_INTERVAL) %
+            m_keyframes.size()];
+        keyframe.sequence = m_next;
+        keyframe.states = m_states;
+        keyframe.activities = m_activities;
+    }
+
+    HistoryTransition &transition = m_ring[m_next % m_capacity];
+    transition.timestamp = timestamp;
+    transition.componentId = (uint16_t)id;
+    transition.oldState = m_states[id];
+    transition.newState = (uint8_t)newState;
+    transition.activityId = activityId;
+    m_next++;
+
+    m_states[id] = (uint8_t)newState;
+    m_activities[id] = activityId;
+}
+
+/*
+ * Get the id of a component, adding it if it is new.
+ *
+ * @param name the component name.
+ * @return the id, from 0 up, -1 if there are too many components.
+ */
+int HistoryRing::getComponentId(const string &name)
+{
+    int id = m_registry.intern(name);
+    if(id >= (int)m_states.size())
+    {
+        m_states.push_back(ComponentStatus::state_unknown);
+        m_activities.push_back(-1);
+    }
+    return id;
+}
+
+/*
+ * Get the name of a component.
+ *
+ * @param id the component id.
+ * @return the name, "" if the id is unknown.
+ */
+const string &HistoryRing::getComponentName(int id) const
+{
+    return m_registry.getName(id);
+}
+
+/*
+ * Get the number of component ids.
+ *
+ * @return the number of component ids.
+ */
+int HistoryRing::getComponentCount() const
+{
+    return m_registry.size();
+}
+
+/*
+ * Get the number of the oldest change that can be shown. The state
+ * before a change can only be rebuilt from a snapshot at or before it,
+ * so the changes before the oldest snapshot still kept are not shown.
+ *
+ * @return the change number.
+ */
+uint64_t HistoryRing::getFirstSequence() const
+{
+    if(m_next <= (uint64_t)m_capacity) return 0;
+
+    uint64_t oldest = m_next - m_capacity;
+    return (oldest + HISTORY_KEYFRAME_INTERVAL - 1) /
+        HISTORY_KEYFRAME_INTERVAL * HISTORY_KEYFRAME_INTERVAL;
+}
+
+/*
+ * Get the number the next change will be given.
+ *
+ * @return the change number.
+ */
+uint64_t HistoryRing::getNextSequence() const
+{
+    return m_next;
+}
+
+/*
+ * Get a change.
+ *
+ * @param sequence the change number, counted from the first ever
+ * added.
+ * @return the change. Only valid from getFirstSequence() up to
+ * but not including getNextSequence().
+ */
+const HistoryTransition &HistoryRing::getTransition(uint64_t sequence) const
+{
+    return m_ring[sequence % m_capacity];
+}
+
+/*
+ * Get the number of the first change after a time.
+ *
+ * @param when the UTC time.
+ * @return the change number, between getFirstSequence() and
+ * getNextSequence().
+ */
+uint64_t HistoryRing::findSequence(time_t when) const
+{
+    uint64_t low = getFirstSequence();
+    uint64_t high = m_next;
+
+    while(low < high)
+    {
+        uint64_t mid = low + (high - low) / 2;
+        if((time_t)getTransition(mid).timestamp <= when) low = mid + 1;
+        else high = mid;
+    }
+
+    return low;
+}
+
+/*
+ * Get the state of every component at a time.
+ *
+ * @param when the UTC time.
+ * @param states set to the component_state_t of each component
+ * id at that time.
+ * @param activities set to the activity of each component id at
+ * that time.
+ * @return false if the time is older than the history kept.
+ */
+bool HistoryRing::getStateAt(time_t when, vector<uint8_t> &states,
+        vector<int32_t> &activities) const
+{
+    uint64_t first = getFirstSequence();
+    uint64_t end = findSequence(when);
+
+    if(end == m_next)
+    {
+        states = m_states;
+        activities = m_activities;
+        return true;
+    }
+
+    if(end == first && first > 0) return false;
+
+    //Start from the snapshot before the change and apply the changes
+    //since, at most HISTORY_KEYFRAME_INTERVAL of them.
+    uint64_t start = end / HISTORY_KEYFRAME_INTERVAL * HISTORY_KEYFRAME_INTERVAL;
+    const Keyframe &keyframe = m_keyframes[(start / HISTORY_KEYFRAME_INTERVAL) %
+        m_keyframes.size()];
+
+    states = keyframe.states;
+    activities = keyframe.activities;
+    states.resize(m_registry.size(), ComponentStatus::state_unknown);
+    activities.resize(m_registry.size(), -1);
+
+    for(uint64_t i = start; i < end; i++)
+    {
+        const HistoryTransition &transition = getTransition(i);
+        states[transition.componentId] = transition.newState;
+        activities[transition.componentId] = transition.activityId;
+    }
+
+    return true;
+}
+
+/*
+ * Get the time of the last change before a time.
+ *
+ * @param when the UTC time.
+ * @return the time of the change, 0 if there is none.
+ */
+time_t HistoryRing::getPreviousTime(time_t when) const
+{
+    uint64_t first = getFirstSequence();
+    uint64_t end = findSequence(when - 1);
+
+    if(end == first) return 0;
+    return getTransition(end - 1).timestamp;
+}
+
+/*
+ * Get the time of the first change after a time.
+ *
+ * @param when the UTC time.
+ * @return the time of the change, 0 if there is none.
+ */
+time_t HistoryRing::getNextTime(time_t when) const
+{
+    uint64_t next = findSequence(when);
+
+    if(next == m_next) return 0;
+    return getTransition(next).timestamp;
+}
+
+/*
+ * Get the time of the oldest change that can be shown.
+ *
+ * @return the time, 0 if there are no changes.
+ */
+time_t HistoryRing::getOldestTime() const
+{
+    if(m_next == 0) return 0;
+    return getTransition(getFirstSequence()).timestamp;
+}
+
+/*
+ * Get the time of the newest record.
+ *
+ * @return the time, 0 if there are no records.
+ */
+time_t HistoryRing::getNewestTime() const
+{
+    return m_newestTime;
+}
@@ -0,0 +1,242 @@
+/*
+ * historyring.h
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * A fixed size history of component state changes.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file historyring.h
+ * A fixed size history of component state changes.
+ */
+
+#ifndef HISTORYRING_H
+#define HISTORYRING_H
+
+#include "componentstatus.h"
+#include "componentregistry.h"
+#include <vector>
+#include <map>
+
+using namespace std;
+
+/** The default number of state changes kept, about 10 hours at 60 dxs. */
+#define HISTORY_RING_CAPACITY (1 << 17)
+
+/** A snapshot of every component is kept every this many changes. */
+#define HISTORY_KEYFRAME_INTERVAL 256
+
+/**
+ * One component state change.
+ */
+struct HistoryTransition
+{
+    /** The record time of the change, seconds since 1/1/70. */
+    uint32_t timestamp;
+    /** The component, an id from HistoryRing::getComponentId(). */
+    uint16_t componentId;
+    /** The state before, a ComponentStatus::component_state_t value. */
+    uint8_t oldState;
+    /** The state after, a ComponentStatus::component_state_t value. */
+    uint8_t newState;
+    /** The activity id after the change, -1 if none. */
+    int32_t activityId;
+};
+
+/**
+ * A fixed size history of component state changes.
+ *
+ * Each complete status record is passed to addRecord(), and every
+ * component whose state differs from the last record adds a 12 byte
+ * HistoryTransition to a ring. When the ring is full the oldest changes
+ * are overwritten.
+ *
+ * Every HISTORY_KEYFRAME_INTERVAL changes the state of every component
+ * is also saved, so the state at any time still in the ring is found
+ * by a binary search for the time, a copy of the snapshot before it and
+ * at most HISTORY_KEYFRAME_INTERVAL changes applied to the copy. How
+ * long ago the time is makes no difference.
+ */
+class HistoryRing
+{
+    public:
+
+        /**
+         * Constructor.
+         *
+         * @param capacity the number of changes to keep. Rounded up to
+         * a multiple of HISTORY_KEYFRAME_INTERVAL.
+         */
+        HistoryRing(int capacity = HISTORY_RING_CAPACITY);
+
+        /**
+         * Add the changes in a complete status record.
+         *
+         * @param recordTime the UTC time of the record.
+         * @param record the parsed components of the record.
+         */
+        void addRecord(time_t recordTime, const vector<ComponentStatus> &record);
+
+        /**
+         * Get the id of a component, adding it if it is new.
+         *
+         * @param name the component name.
+         * @return the id, from 0 up, -1 if there are too many components.
+         */
+        int getComponentId(const string &name);
+
+        /**
+         * Get the name of a component.
+         *
+         * @param id the component id.
+         * @return the name, "" if the id is unknown.
+         */
+        const string &getComponentName(int id) const;
+
+        /**
+         * Get the number of component ids.
+         *
+         * @return the number of component ids.
+         */
+        int getComponentCount() const;
+
+        /**
+         * Get the state of every component at a time.
+         *
+         * @param when the UTC time.
+         * @param states set to the component_state_t of each component
+         * id at that time.
+         * @param activities set to the activity of each component id at
+         * that time.
+         * @return false if the time is older than the history kept.
+         */
+        bool getStateAt(time_t when, vector<uint8_t> &states,
+                vector<int32_t> &activities) const;
+
+        /**
+         * Get the time of the last change before a time.
+         *
+         * @param when the UTC time.
+         * @return the time of the change, 0 if there is none.
+         */
+        time_t getPreviousTime(time_t when) const;
+
+        /**
+         * Get the time of the first change after a time.
+         *
+         * @param when the UTC time.
+         * @return the time of the change, 0 if there is none.
+         */
+        time_t getNextTime(time_t when) const;
+
+        /**
+         * Get the time of the oldest change that can be shown.
+         *
+         * @return the time, 0 if there are no changes.
+         */
+        time_t getOldestTime() const;
+
+        /**
+         * Get the time of the newest record.
+         *
+         * @return the time, 0 if there are no records.
+         */
+        time_t getNewestTime() const;
+
+        /**
+         * Get a change.
+         *
+         * @param sequence the change number, counted from the first ever
+         * added.
+         * @return the change. Only valid from getFirstSequence() up to
+         * but not including getNextSequence().
+         */
+        const HistoryTransition &getTransition(uint64_t sequence) const;
+
+        /**
+         * Get the number of the oldest change that can be shown. The state
+         * before a change can only be rebuilt from a snapshot at or before it,
+         * so the changes before the oldest snapshot still kept are not shown.
+         *
+         * @return the change number.
+         */
+        uint64_t getFirstSequence() const;
+
+        /**
+         * Get the number the next change will be given.
+         *
+         * @return the change number.
+         */
+        uint64_t getNextSequence() const;
+
+        /**
+         * Get the number of the first change after a time.
+         *
+         * @param when the UTC time.
+         * @return the change number, between getFirstSequence() and
+         * getNextSequence().
+         */
+        uint64_t findSequence(time_t when) const;
+
+    private:
+
+        /**
+         * The state of every component before one change.
+         */
+        struct Keyframe
+        {
+            /** The number of the change the snapshot is before. */
+            uint64_t sequence;
+            /** The state of each component id. */
+            vector<uint8_t> states;
+            /** The activity of each component id. */
+            vector<int32_t> activities;
+        };
+
+        /**
+         * Add one change.
+         */
+        void addTransition(uint32_t timestamp, int id, int newState, int32_t activityId);
+
+        int m_capacity;
+        vector<HistoryTransition> m_ring;
+        vector<Keyframe> m_keyframes;
+
+        /** The number the next change will be given. */
+        uint64_t m_next;
+
+        /** The current state and activity of each component id. */
+        vector<uint8_t> m_states;
+        vector<int32_t> m_activities;
+
+        /** The time of the newest record. */
+        uint32_t m_newestTime;
+
+        /** Component ids by name, and names by id. */
+        ComponentRegistry m_registry;
+};
+
+#endif //HISTORYRING_H
+
@@ -0,0 +1,199 @@
+/*
+ * latencyhistogram.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * A fixed size histogram of latencies.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file latencyhistogram.cpp
+ * A fixed size histogram of latencies.
+ */
+
+#include "latencyhistogram.h"
+#include <string.h>
+
+/* Constructor. */
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+/*
+ * Forget all the recorded values.
+ */
+void LatencyHistogram::reset()
+{
+    memset(m_counts, 0, sizeof(m_counts));
+    m_count = 0;
+    m_sum = 0;
+    m_min = 0;
+    m_max = 0;
+}
+
+/*
+ * Get the bucket index for a value.
+ *
+ * @param value the value.
+ * @return the bucket index.
+ */
+int LatencyHistogram::indexOf(uint64_t value)
+{
+    if(value < (uint64_t)SUB_BUCKETS) return (int)value;
+
+    int msb = 63 - __builtin_clzll(value);
+    if(msb >= MAX_BITS) return BUCKETS - 1;
+
+    //The top SUB_BUCKET_BITS+1 bits of the value pick the sub bucket.
+    int shift = msb - SUB_BUCKET_BITS;
+    int sub = (int)(value >> shift) - SUB_BUCKETS;
+
+    return SUB_BUCKETS + shift * SUB_BUCKETS + sub;
+}
+
+/*
+ * Get the largest value that falls in a bucket.
+ *
+ * @param index the bucket index.
+ * @return the largest value in the bucket.
+ */
+uint64_t LatencyHistogram::upperBoundOf(int index)
+{
+    if(index < SUB_BUCKETS) return (uint64_t)index;
+
+    int shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+    uint64_t sub = (uint64_t)((index - SUB_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS);
+
+    return ((sub + 1) << shift) - 1;
+}
+
+/*
+ * Record one value.
+ *
+ * @param value the value to record.
+ */
+void LatencyHistogram::record(uint64_t value)
+{
+    m_counts[indexOf(value)]++;
+
+    if(m_count == 0 || value < m_min) m_min = value;
+    if(value > m_max) m_max = value;
+    m_count++;
+    m_sum += value;
+}
+
+/*
+ * Add all the values of another histogram to this one.
+ *
+ * @param other the histogram to add.
+ */
+void LatencyHistogram::add(const LatencyHistogram &other)
+{
+    if(other.m_count == 0) return;
+
+    for(int i = 0; i < BUCKETS; i++)
+        m_counts[i] += other.m_counts[i];
+
+    if(m_count == 0 || other.m_min < m_min) m_min = other.m_min;
+    if(other.m_max > m_max) m_max = other.m_max;
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+}
+
+/*
+ * Get the number of recorded values.
+ *
+ * @return the number of recorded values.
+ */
+uint64_t LatencyHistogram::getCount() const
+{
+    return m_count;
+}
+
+/*
+ * Get the smallest recorded value.
+ *
+ * @return the smallest recorded value, 0 if none are recorded.
+ */
+uint64_t LatencyHistogram::getMin() const
+{
+    return m_min;
+}
+
+/*
+ * Get the largest recorded value.
+ *
+ * @return the largest recorded value, 0 if none are recorded.
+ */
+uint64_t LatencyHistogram::getMax() const
+{
+    return m_max;
+}
+
+/*
+ * Get the mean of the recorded values.
+ *
+ * @return the mean, 0 if none are recorded.
+ */
+double LatencyHistogram::getMean() const
+{
+    if(m_count == 0) return 0.0;
+    return (double)m_sum / (double)m_count;
+}
+
+/*
+ * Get the value at a percentile.
+ *
+ * @param percentile the percentile, 0.0 to 100.0.
+ * @return the upper bound of the bucket holding the percentile,
+ * never more than the largest recorded value. 0 if none are
+ * recorded.
+ */
+uint64_t LatencyHistogram::getPercentile(double percentile) const
+{
+    if(m_count == 0) return 0;
+
+    if(percentile < 0.0) percentile = 0.0;
+    if(percentile > 100.0) percentile = 100.0;
+
+    //The rank of the value wanted, 1 to m_count.
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)m_count + 0.5);
+    if(rank < 1) rank = 1;
+
+    uint64_t seen = 0;
+    for(int i = 0; i < BUCKETS; i++)
+    {
+        seen += m_counts[i];
+        if(seen >= rank)
+        {
+            uint64_t value = upperBoundOf(i);
+            if(value > m_max) value = m_max;
+            if(value < m_min) value = m_min;
+            return value;
+        }
+    }
+
+    return m_max;
+}
@@ -0,0 +1,151 @@
+/*
+ * latencyhistogram.h
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * A fixed size histogram of latencies.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file latencyhistogram.h
+ * A fixed size histogram of latencies.
+ */
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <stdint.h>
+
+/**
+ * A fixed size histogram of latencies, in the style of an HDR histogram.
+ *
+ * Values below 2^SUB_BUCKET_BITS are counted exactly. Larger values
+ * fall into log2 sized buckets that are each divided into
+ * 2^SUB_BUCKET_BITS linear sub buckets, so any reported percentile is
+ * within 1/2^SUB_BUCKET_BITS (6.25%) of the true value. The units are
+ * up to the caller. Recording is O(1) and never allocates.
+ */
+class LatencyHistogram
+{
+    public:
+
+        /** Constructor. */
+        LatencyHistogram();
+
+        /**
+         * Record one value.
+         *
+         * @param value the value to record.
+         */
+        void record(uint64_t value);
+
+        /**
+         * Add all the values of another histogram to this one.
+         *
+         * @param other the histogram to add.
+         */
+        void add(const LatencyHistogram &other);
+
+        /**
+         * Forget all the recorded values.
+         */
+        void reset();
+
+        /**
+         * Get the number of recorded values.
+         *
+         * @return the number of recorded values.
+         */
+        uint64_t getCount() const;
+
+        /**
+         * Get the smallest recorded value.
+         *
+         * @return the smallest recorded value, 0 if none are recorded.
+         */
+        uint64_t getMin() const;
+
+        /**
+         * Get the largest recorded value.
+         *
+         * @return the largest recorded value, 0 if none are recorded.
+         */
+        uint64_t getMax() const;
+
+        /**
+         * Get the mean of the recorded values.
+         *
+         * @return the mean, 0 if none are recorded.
+         */
+        double getMean() const;
+
+        /**
+         * Get the value at a percentile.
+         *
+         * @param percentile the percentile, 0.0 to 100.0.
+         * @return the upper bound of the bucket holding the percentile,
+         * never more than the largest recorded value. 0 if none are
+         * recorded.
+         */
+        uint64_t getPercentile(double percentile) const;
+
+    private:
+
+        /** log2 of the number of linear sub buckets per power of 2. */
+        static const int SUB_BUCKET_BITS = 4;
+
+        /** The number of linear sub buckets per power of 2. */
+        static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+        /** Values at or above 2^MAX_BITS share the top bucket. */
+        static const int MAX_BITS = 48;
+
+        /** The total number of buckets. */
+        static const int BUCKETS = SUB_BUCKETS * (MAX_BITS - SUB_BUCKET_BITS + 1);
+
+        /**
+         * Get the bucket index for a value.
+         *
+         * @param value the value.
+         * @return the bucket index.
+         */
+        static int indexOf(uint64_t value);
+
+        /**
+         * Get the largest value that falls in a bucket.
+         *
+         * @param index the bucket index.
+         * @return the largest value in the bucket.
+         */
+        static uint64_t upperBoundOf(int index);
+
+        uint32_t m_counts[BUCKETS];
+        uint64_t m_count;
+        uint64_t m_sum;
+        uint64_t m_min;
+        uint64_t m_max;
+};
+
+#endif //LATENCYHISTOGRAM_H
+
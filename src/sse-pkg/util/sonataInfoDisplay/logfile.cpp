@@ -33,6 +33,8 @@
  */
 
 #include "logfile.h"
+#include "diagnostics.h"
+#include <string.h>
 
 int Logfile::m_maxFd = 0;
 fd_set Logfile::m_rfds;
@@ -135,15 +137,47 @@ void Logfile::getLine(char *buf, unsigned long bufsize)
 {
     char *s = fgets(buf, bufsize, m_fp);
 
-    if (s == NULL)
+    if (s != NULL)
+    {
+        Diagnostics::count(Diagnostics::counter_bytes_read, strlen(s));
+    }
+    else
     {
         if (feof(m_fp))
         {
+            // Clear EOF so lines appended later can be read.
+            clearerr(m_fp);
             checkRefresh();
         }
     }
 }
 
+/*
+ * Reads binary data from logfile.
+ *
+ * @param buf buffer for storing the data
+ * @param bufsize size of buffer for storing the data
+ *
+ * @return the number of bytes read, 0 at the end of the file
+ */
+unsigned long Logfile::read(char *buf, unsigned long bufsize)
+{
+    unsigned long count = fread(buf, 1, bufsize, m_fp);
+    Diagnostics::count(Diagnostics::counter_bytes_read, count);
+
+    if (count < bufsize && feof(m_fp))
+    {
+        // Clear EOF so data appended later can be read.
+        clearerr(m_fp);
+        if (count == 0)
+        {
+            checkRefresh();
+        }
+    }
+
+    return count;
+}
+
 /*
  * Reads from all Logfile instances.
  *
@@ -174,7 +208,10 @@ int Logfile::readLogfiles(list<Logfile> logfiles)
     // immediately when a descriptor in the set is at EOF.
     //
     // Consider a delay by e.g. opting out of &m_rfds for n passes when at EOF?
+    uint64_t start = Diagnostics::now();
     retVal = select(Logfile::m_maxFd + 1, &m_rfds, NULL, NULL, &tv);
+    Diagnostics::record(Diagnostics::timing_select_wait, start);
+    Diagnostics::count(Diagnostics::counter_select_wakeups);
 
     return retVal;
 }
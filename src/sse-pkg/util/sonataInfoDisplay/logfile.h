@@ -81,6 +81,16 @@ using namespace std;
          */
         void getLine(char *buf, unsigned long bufsize);
 
+        /**
+         * Reads binary data from logfile.
+         *
+         * @param buf buffer for storing the data
+         * @param bufsize size of buffer for storing the data
+         *
+         * @return the number of bytes read, 0 at the end of the file
+         */
+        unsigned long read(char *buf, unsigned long bufsize);
+
         /**
          * Reads from all Logfile instances.
 	 *
@@ -47,7 +47,60 @@
 #include "screen.h"
 #include "components.h"
 #include "logfile.h"
+#include "activities.h"
+#include "history.h"
+#include "errorlog.h"
+#include "signals.h"
+#include "summary.h"
+#include "statusfeed.h"
+#include "statusboard.h"
+#include "statusdelta.h"
+#include "federation.h"
+#include "statusarchive.h"
+#include "diagnostics.h"
 #include <list>
+#include <unistd.h>
+
+/**
+ * Print the status record at a time from a status archive, as it was
+ * in "sse-system-status.txt".
+ *
+ * @param archiveName the status archive.
+ * @param timeText the UTC time, "YYYY-MM-DD HH:MM:SS".
+ * @return the exit code, 0 if the record was printed.
+ */
+static int printArchive(const string &archiveName, const string &timeText)
+{
+    StatusArchive archive;
+    StatusFeedHeader header;
+    vector<string> lines;
+    struct tm t;
+
+    memset(&t, 0, sizeof(t));
+    const char *end = strptime(timeText.c_str(), "%Y-%m-%d %H:%M:%S", &t);
+    if(end == NULL || *end != 0)
+    {
+        fprintf(stderr, "Bad time %s, expected YYYY-MM-DD HH:MM:SS\n", timeText.c_str());
+        return(1);
+    }
+
+    if(!archive.open(archiveName))
+    {
+        fprintf(stderr, "Could not open %s\n", archiveName.c_str());
+        return(1);
+    }
+
+    if(!archive.read(timegm(&t), header, lines))
+    {
+        fprintf(stderr, "No record at %s in %s\n", timeText.c_str(), archiveName.c_str());
+        return(1);
+    }
+
+    for(int i = 0; i < (int)lines.size(); i++) printf("%s\n", lines[i].c_str());
+    printf("============================================================\n");
+
+    return(0);
+}
 
 /**
  * Main entry point of the program.
@@ -60,9 +113,38 @@
  *  - The error log  file that is created in real time when SonATA
  *    is running. This is usually "errorlog-YYYY-MM-DD.txt".
  *
- * Note: This version does not actually process "systemlog-YYYY-MM-DD.txt" and
- * "errorlog-YYYY-MM-DD.txt". Future development will involve implementing 
- * the reading and displaying of the information in these files.
+ * Options, before the files:
+ *  - -b file: also write each status record to a binary status feed,
+ *    see StatusFeed.
+ *  - -B: the system status file is a binary status feed instead of
+ *    "sse-system-status.txt".
+ *  - -P: publish each status record on the shared memory status board,
+ *    see StatusBoard.
+ *  - -V: view the status board instead of reading a status file. The
+ *    system status file argument is left out.
+ *  - -H json|binary: headless, with no curses screen. Write the
+ *    components that change in each status record to stdout, see
+ *    StatusDelta.
+ *  - -S socket: with -H, write the changes to the clients of a local
+ *    UNIX socket instead of stdout.
+ *  - -F site=path: merge the status of a site, read from the socket of
+ *    an instance run with "-H binary -S path" or from a binary status
+ *    feed file, see Federation. Repeat for each site. Site names are
+ *    at most FEDERATION_MAX_SITE_NAME characters. As with -V, the system
+ *    status file argument is left out, and there is no activity screen.
+ *  - -A archive: also append each status record to a compressed status
+ *    archive, see StatusArchive.
+ *  - -R archive -T "YYYY-MM-DD HH:MM:SS": print the status record at
+ *    that UTC time from a status archive and exit. No files are needed.
+ *
+ * Counts and timings of the work done, and the latency of each status
+ * record from its "NSS" time to the screen, are shown on the diagnostics
+ * screen, and appended to DIAGNOSTICS_DUMP_FILE on SIGUSR1, see
+ * Diagnostics.
+ *
+ * The signal reports in "systemlog-YYYY-MM-DD.txt" are shown on the
+ * signals screen, see Signals, and "errorlog-YYYY-MM-DD.txt" on the errors
+ * screen, see ErrorLog.
  */
 int main(int argc, char **argv)
 {
@@ -74,39 +156,171 @@ int main(int argc, char **argv)
     list<Logfile> logfiles;
 
     Components componentDetails;
+    Activities activityDetails;
+    History historyDetails;
+    ErrorLog errorDetails;
+    Signals signalDetails;
+    Summary summaryDetails;
+    Diagnostics diagnosticsDetails;
+
+    string feedFileName = "";
+    bool binaryStatus = false;
+    StatusFeed feed;
+    StatusFeedHeader feedHeader;
+    vector<ComponentStatus> feedRecord;
+    string feedBuffer;
+    bool publishBoard = false;
+    bool viewBoard = false;
+    StatusBoard board;
+    string headlessFormat = "";
+    string socketPath = "";
+    StatusDelta *delta = NULL;
+    Federation federation;
+    string archiveFileName = "";
+    StatusArchive archive;
+    string readArchiveName = "";
+    string readArchiveTime = "";
+
+    int opt;
+    bool badOption = false;
+    while((opt = getopt(argc, argv, "b:BPVH:S:F:A:R:T:")) != -1)
+    {
+        if(opt == 'b') feedFileName = optarg;
+        else if(opt == 'B') binaryStatus = true;
+        else if(opt == 'P') publishBoard = true;
+        else if(opt == 'V') viewBoard = true;
+        else if(opt == 'H') headlessFormat = optarg;
+        else if(opt == 'S') socketPath = optarg;
+        else if(opt == 'A') archiveFileName = optarg;
+        else if(opt == 'R') readArchiveName = optarg;
+        else if(opt == 'T') readArchiveTime = optarg;
+        else if(opt == 'F')
+        {
+            string site = optarg;
+            size_t equals = site.find('=');
+            if(equals == string::npos ||
+                    !federation.addSite(site.substr(0, equals), site.substr(equals + 1)))
+                badOption = true;
+        }
+        else badOption = true;
+    }
 
     // Print help if not enough arguments on the command line
-    if (argc < 3)
+    if (headlessFormat != "" && headlessFormat != "json" && headlessFormat != "binary")
+        badOption = true;
+    if (socketPath != "" && headlessFormat == "") badOption = true;
+    if ((readArchiveName == "") != (readArchiveTime == "")) badOption = true;
+    bool federating = (federation.getSiteCount() > 0);
+    if (federating && (viewBoard || binaryStatus)) badOption = true;
+
+    if (!badOption && readArchiveName != "")
+        return printArchive(readArchiveName, readArchiveTime);
+
+    if (badOption || argc - optind < ((viewBoard || federating) ? 2 : 3))
     {
         fprintf(stderr, "\nsonataInfoDisplay - curses display for SonATA information\n\n");
-        fprintf(stderr, "  USAGE: sonataInfoDisplay <sse-system-status.txt> \\\n");
+        fprintf(stderr, "  USAGE: sonataInfoDisplay [-b feed] [-B] [-P] [-A archive] \\\n");
+        fprintf(stderr, "         [-H json|binary [-S path]] <sse-system-status.txt> \\\n");
         fprintf(stderr, "         <systemlog-YYYY-MM-DD.txt> <errorlog-YYYY-MM-DD.txt>\n");
+        fprintf(stderr, "         sonataInfoDisplay -V \\\n");
+        fprintf(stderr, "         <systemlog-YYYY-MM-DD.txt> <errorlog-YYYY-MM-DD.txt>\n");
+        fprintf(stderr, "         sonataInfoDisplay -F site=path [-F site=path ...] \\\n");
+        fprintf(stderr, "         [-b feed] [-P] [-A archive] [-H json|binary [-S path]] \\\n");
+        fprintf(stderr, "         <systemlog-YYYY-MM-DD.txt> <errorlog-YYYY-MM-DD.txt>\n");
+        fprintf(stderr, "         sonataInfoDisplay -R archive -T \"YYYY-MM-DD HH:MM:SS\"\n");
+        fprintf(stderr, "  -b feed  Also write the status records to a binary status feed.\n");
+        fprintf(stderr, "  -B       The status file is a binary status feed.\n");
+        fprintf(stderr, "  -P       Publish the status records on the status board.\n");
+        fprintf(stderr, "  -V       View the status board published by another instance.\n");
+        fprintf(stderr, "  -H fmt   Headless, write the changed components of each record\n");
+        fprintf(stderr, "           as json lines or binary status feed records.\n");
+        fprintf(stderr, "  -S path  With -H, write to the clients of a UNIX socket, not stdout.\n");
+        fprintf(stderr, "  -F site=path  Merge a site from the socket of an instance run with\n");
+        fprintf(stderr, "           -H binary -S path, or from a binary status feed file.\n");
+        fprintf(stderr, "           The site name is at most %d characters.\n", FEDERATION_MAX_SITE_NAME);
+        fprintf(stderr, "  -A archive  Also append the status records to a status archive.\n");
+        fprintf(stderr, "  -R archive  Print the record at the UTC time given with -T and exit.\n");
         fprintf(stderr, "  NOTE:  The arguments need to be the file prefixed with the path.\n\n");
         return(1);
     }
 
     // Read in the arguments.
-    systemStatusFileName = argv[1]; 
-    systemLogFileName    = argv[2]; 
-    systemErrorFileName  = argv[3]; 
+    if(!viewBoard && !federating) systemStatusFileName = argv[optind++]; 
+    systemLogFileName    = argv[optind]; 
+    systemErrorFileName  = argv[optind + 1]; 
 
-    Logfile systemStatusFile = Logfile(systemStatusFileName);
+    if(feedFileName != "" && !feed.open(feedFileName))
+    {
+        fprintf(stderr, "Could not open %s\n", feedFileName.c_str());
+        return(1);
+    }
+
+    if(archiveFileName != "" && !archive.create(archiveFileName))
+    {
+        fprintf(stderr, "Could not open %s\n", archiveFileName.c_str());
+        return(1);
+    }
+
+    if(publishBoard && !board.create(STATUS_BOARD_NAME))
+    {
+        fprintf(stderr, "Could not create the status board %s, is another publisher (-P) running?\n",
+                STATUS_BOARD_NAME);
+        return(1);
+    }
+
+    if(viewBoard && !board.attach(STATUS_BOARD_NAME))
+    {
+        fprintf(stderr, "Could not attach to the status board %s, is a publisher (-P) running?\n",
+                STATUS_BOARD_NAME);
+        return(1);
+    }
+
+    if(headlessFormat != "")
+    {
+        delta = new StatusDelta((headlessFormat == "binary") ?
+                StatusDelta::format_binary : StatusDelta::format_json);
+        if(socketPath != "" && !delta->listen(socketPath))
+        {
+            fprintf(stderr, "Could not listen on %s\n", socketPath.c_str());
+            return(1);
+        }
+    }
+
+    Logfile *systemStatusFile = NULL;
+    if(!viewBoard && !federating)
+    {
+        systemStatusFile = new Logfile(systemStatusFileName);
+        logfiles.push_back(*systemStatusFile);
+    }
     Logfile systemLogFile = Logfile(systemLogFileName);
     Logfile systemErrorFile = Logfile(systemErrorFileName);
 
-    logfiles.push_back(systemStatusFile);
     logfiles.push_back(systemLogFile);
     logfiles.push_back(systemErrorFile);
 
+    screen.setDetails(Screen::screen_mode_components, &componentDetails);
+    screen.setDetails(Screen::screen_mode_signals, &signalDetails);
+    screen.setDetails(Screen::screen_mode_errors, &errorDetails);
+    screen.setDetails(Screen::screen_mode_summary, &summaryDetails);
+    //The activities of several sites are not one sequence.
+    if(!federating) screen.setDetails(Screen::screen_mode_activity, &activityDetails);
+    screen.setDetails(Screen::screen_mode_history, &historyDetails);
+    screen.setDetails(Screen::screen_mode_diagnostics, &diagnosticsDetails);
+
     //Initialize the curses screen.
-    screen.init();
-    screen.screenResize(0);
+    if(delta == NULL)
+    {
+        screen.init();
+        screen.screenResize(0);
+    }
 
     time_t lastStatusTime = time(NULL);;
     int linesSinceLastStatus = 0;
+    time_t lastLogPaintTime = 0;
+    bool logsChanged = false;
 
-    //Loop foever
-    while(1)
+    //Loop until SIGINT or SIGTERM
+    while(!Screen::isFinishRequested())
     {
 
         Logfile::readLogfiles(logfiles);
@@ -115,38 +329,154 @@ int main(int argc, char **argv)
         // (Note the current clumsy use of Logfile::m_rfds.)
 
         // Process any data read from the status file.
-        if(FD_ISSET(systemStatusFile.getFd(), Logfile::getDescriptors()))
+        bool haveRecord = false;
+        bool forcedRecord = false;
+        if(viewBoard)
         {
-            systemStatusFile.getLine(line, sizeof(line) - 1);
-            if(line[0] != 0 && componentDetails.addWithFilter(line))
-                screen.paint(&componentDetails);
-            linesSinceLastStatus++;
+            if(board.read(feedHeader, feedRecord))
+            {
+                Diagnostics::traceRead();
+                componentDetails.setRecord(feedHeader, feedRecord);
+                haveRecord = true;
+            }
+        }
+        else if(federating)
+        {
+            if(federation.poll(feedHeader, feedRecord))
+            {
+                Diagnostics::traceRead();
+                componentDetails.setRecord(feedHeader, feedRecord);
+                haveRecord = true;
+            }
+        }
+        else if(binaryStatus)
+        {
+            //Take one record per pass, reading more only when there is
+            //not a whole one buffered.
+            int used = StatusFeed::decode(feedBuffer.data(), 
+                    (int)feedBuffer.size(), feedHeader, feedRecord);
+            if(used < 0)
+            {
+                //Not a record, skip to the next one.
+                size_t next = feedBuffer.find(STATUS_FEED_MAGIC, 1);
+                feedBuffer.erase(0, next);
+            }
+            else if(used > 0)
+            {
+                feedBuffer.erase(0, used);
+                Diagnostics::traceRead();
+                componentDetails.setRecord(feedHeader, feedRecord);
+                haveRecord = true;
+            }
+            else if(FD_ISSET(systemStatusFile->getFd(), Logfile::getDescriptors()))
+            {
+                unsigned long count = systemStatusFile->read(line, sizeof(line));
+                if(count > 0) Diagnostics::traceRead();
+                feedBuffer.append(line, count);
+            }
+        }
+        else if(FD_ISSET(systemStatusFile->getFd(), Logfile::getDescriptors()))
+        {
+            systemStatusFile->getLine(line, sizeof(line) - 1);
+            if(line[0] != 0)
+            {
+                Diagnostics::traceRead();
+                if(linesSinceLastStatus == 0) lastStatusTime = time(NULL);
+                linesSinceLastStatus++;
+                if(componentDetails.addWithFilter(line))
+                {
+                    Diagnostics::count(Diagnostics::counter_records_completed);
+                    linesSinceLastStatus = 0;
+                    lastStatusTime = time(NULL);
+                    haveRecord = true;
+                }
+            }
             memset(line, 0, sizeof(line));
         }
 
-        //The trigger for the end of a status screen paint is "===..." but sometimes
+        //The trigger for the end of a status record is "===..." but sometimes
         //this does not arrive, so we have to force it.
-        if(linesSinceLastStatus > 0 && (int)(time(NULL) - lastStatusTime) > 1)
+        if(!haveRecord && linesSinceLastStatus > 0 && (int)(time(NULL) - lastStatusTime) > 1)
         {
             linesSinceLastStatus = 0;
             lastStatusTime = time(NULL);
+            Diagnostics::traceForced();
             componentDetails.addWithFilter("====================================");
-            screen.paint(&componentDetails);
+            Diagnostics::count(Diagnostics::counter_records_forced);
+            haveRecord = true;
+            forcedRecord = true;
+        }
+
+        // Pass a complete record on to everything that uses it. A forced
+        // record may be missing components, or have the rest still to
+        // come, so it is only shown, not written or sent anywhere.
+        if(haveRecord)
+        {
+            const vector<ComponentStatus> &record = componentDetails.getRecord();
+            StatusFeedHeader header = componentDetails.getRecordHeader();
+
+            if(!federating) activityDetails.addRecord(componentDetails.getRecordTime(), record);
+            historyDetails.addRecord(componentDetails.getRecordTime(), record);
+            summaryDetails.addRecord(componentDetails.getRecordTime(), header, record);
+            if(!forcedRecord)
+            {
+                if(feedFileName != "") feed.write(header, record);
+                if(archiveFileName != "") archive.write(header, componentDetails.getRecordText());
+                if(publishBoard) board.publish(header, record);
+                if(delta != NULL) delta->write(header, record);
+            }
+            Diagnostics::traceStage(Diagnostics::trace_published);
+            screen.paint();
+            Diagnostics::traceStage(Diagnostics::trace_painted);
+            Diagnostics::traceEnd();
+        }
+        else if(delta != NULL)
+        {
+            delta->poll();
         }
 
         //Process the log file
         if(FD_ISSET(systemLogFile.getFd(), Logfile::getDescriptors()))
         {
+            line[0] = 0;
+            systemLogFile.getLine(line, sizeof(line) - 1);
+            if(line[0] != 0 && signalDetails.addLine(line))
+            {
+                const Signal &signal = signalDetails.getSignal(signalDetails.size() - 1);
+                if(signal.sigClass == Signals::class_cand) summaryDetails.addCandidate();
+                logsChanged = true;
+            }
+            memset(line, 0, sizeof(line));
         }
 
         //Process the error file
         if(FD_ISSET(systemErrorFile.getFd(), Logfile::getDescriptors()))
         {
+            line[0] = 0;
+            systemErrorFile.getLine(line, sizeof(line) - 1);
+            if(line[0] != 0 && errorDetails.addLine(line)) logsChanged = true;
+            memset(line, 0, sizeof(line));
         }
 
-        screen.processKey(&componentDetails);
+        //Busy logs are repainted at most once a second.
+        if(logsChanged && time(NULL) != lastLogPaintTime)
+        {
+            logsChanged = false;
+            lastLogPaintTime = time(NULL);
+            screen.paint();
+        }
+
+        if(archiveFileName != "") archive.flushOld();
+
+        if(Diagnostics::isDumpRequested()) diagnosticsDetails.dump(DIAGNOSTICS_DUMP_FILE);
+
+        screen.processKey();
     }
 
+    //Write the block being filled before the records are lost.
+    if(archiveFileName != "") archive.close();
+    delete delta;
+    screen.end();
 
     return 0;
 
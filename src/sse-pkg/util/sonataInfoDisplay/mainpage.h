@@ -16,6 +16,27 @@
  * </p>
  * <p>There is a command line option -p that makes this program read from already created files.
  * </p>
+ * <p>The screens available are listed along the bottom line. Switch between them with the number keys (or the function keys), page through a screen with 8 and 9.
+ * <ul>
+ *  <li><i>1-Status</i> - The status of each component, from sse-system-status.txt.</li>
+ *  <li><i>2-Signals</i> - The signal reports of the current activity from the systemlog, one line per signal with its dx, frequency, polarization, drift, width, SNR, class and reason. Candidates are shown in green. Press o to change the sort order (frequency, class, SNR or dx), and c, p or r to step through the classes, polarizations or reasons to show only those signals.</li>
+ *  <li><i>3-Errors</i> - The error log, newest first. Press s to pick a severity, c to pick the component that reported it and t to show only today.</li>
+ *  <li><i>4-Summary</i> - Totals for each of the last 48 hours: activities completed, candidates per activity, mean seconds in baseline accumulation, data collection and signal detection, dx minutes offline and the bandwidth covered. Press n for the same by night (the 24 hours from 20:00 UTC) over the last 14 nights.</li>
+ *  <li><i>5-Activity</i> - How long each dx spends in baseline accumulation, data collection and signal detection (p50/p99/max over all the activities seen), slowest signal detection first. This shows which dxs make every activity wait. Press m for the model view, which rates how slow each dx is and how heavy each channel is to search, and suggests a channel assignment that puts the heaviest channels on the fastest dxs.</li>
+ *  <li><i>6-History</i> - The state of every component at a past time, from a fixed size history of state changes (about 10 hours for 60 dxs). Press the left and right arrows to step to the previous or next change, [ and ] to step 10 minutes, and l to go back to live.</li>
+ *  <li><i>7-Diag</i> - Where the display spends its time: how often select() wakes up, bytes read, status lines parsed, records ended by "=====" or forced by the 1 second timer, paints and screen cells changed, with totals and rates, and the time to wait in select(), parse a status line and paint the screen (min/mean/p50/p99/max). Each status record is also traced from the time on its NSS line to the first of its lines being read, its ===== line, its publishing and the screen being painted, with the delay of each stage and of the whole, and a count of the records painted more than 3 seconds after their NSS time. The NSS time is in whole seconds, so the first stage reads up to a second long. Send the display SIGUSR1 to append the same to /tmp/sonataInfoDisplay-diagnostics.txt, also when headless.</li>
+ * </ul>
+ * </p>
+ * <p>Run with <i>-b file</i> to also write every status record to a binary status feed, one fixed size record per component holding its state, activity, sky frequency, channel and time (see StatusFeed). Run with <i>-B</i> to display a binary status feed in place of "sse-system-status.txt"; it is loaded without any text parsing.
+ * </p>
+ * <p>To run several displays on one machine, run one with <i>-P</i> to publish each status record to a shared memory status board, and the others with <i>-V</i> (and without the status file argument) to view it. The viewers do no parsing and check for a new record without any system calls (see StatusBoard).
+ * </p>
+ * <p>Run with <i>-H json</i> or <i>-H binary</i> for a headless display with no curses screen, for scripts and monitoring. Only the components that change in each status record are written, as one JSON object per line or as binary status feed records, to stdout or with <i>-S path</i> to the clients of a local UNIX socket (see StatusDelta).
+ * </p>
+ * <p>To watch several sites (e.g. the ATA, Arecibo and Jodrell Bank) on one screen, run a headless <i>-H binary -S path</i> instance at each site and a display with <i>-F site=path</i> for each of them, again without the status file argument. Each component is shown with its site name in front, as in "ata:dx1000", so site names are kept to 4 characters. The activity screen is left out, as each site runs its own activities. Only the changes are sent by each site, so the traffic follows how often things change rather than how many components there are. A binary status feed file can stand in for a site (see Federation).
+ * </p>
+ * <p>Run with <i>-A archive</i> to also keep every status record in a compressed status archive for post-mortems. The text of the status lines is kept, so a record read back is what was in the file. Each record holds only the lines that changed, with the record time taken out, every few minutes a whole record is kept, and the blocks are compressed with zlib, which makes the archive well over 20 times smaller than "sse-system-status.txt". Run <i>sonataInfoDisplay -R archive -T "YYYY-MM-DD HH:MM:SS"</i> to print the record at a UTC time; it is found through the index kept beside the archive, so it takes as long in a months old archive as in a new one (see StatusArchive).
+ * </p>
  * <p>The code is C++. The main entry point to the program is in main.cpp. That would be a good place to start investigating the code.
  * </p>
  *
@@ -26,8 +47,8 @@
  * <p>When running SonATA (either by initiating the sonata-gen or sonata-vger scripts) this program can act as a replacement for the System Status window. You need to supply the program with the paths to 3 files:
  * <ul>
  *  <li><i>sse-system-status.txt</i> - Contains the status of the various system components such as channelizers, dx's, etc.</li>
- *  <li><i>error-2010-08-04.txt</i> - Contains the errors and warnings. Obviosly the date changes to the current date in the filename. Note that this file is not actually parsed in this version of sonataInfoDisplay. See below for information on how you can help.</li>
- *  <li><i>systemlog-2010-08-04.txt</i> - Contains signal detection reports. Also, this file is not actually parsed in this version of sonataInfoDisplay. See below for information on how you can help.</li>
+ *  <li><i>error-2010-08-04.txt</i> - Contains the errors and warnings. Obviosly the date changes to the current date in the filename. Shown on the errors screen.</li>
+ *  <li><i>systemlog-2010-08-04.txt</i> - Contains signal detection reports. Shown on the signals screen.</li>
  * </ul>
  * <p>To start sonataInfoDisplay, change to the root OpenSonATA_2.0 directory and initiate the following command:
  * <ul>
@@ -48,8 +69,6 @@
  *     <li>This program opens and read from various system files and parse the information for display. When The seeker is restarted, the seeker reopens these files, thus, sonataInfoDisplay needs to be restarted to re-initiate the reading. It would be best if this situation could be handled in the program and reset the file pointers upon this type of event.</li>
  *     <li>Occasionally this program slows down to a crawl. It seems to be in components::addWithFilter() and be associated with resizing the screen. When the slow down occurs, resizing the terminal window brings it back to life. Can anyone spot a memory leak or something that is being done ineffiently?</li>
  *     <li>Does anyone have any suggestions for any open source (or free) memory checker applications that would be suitable to review this code for leaks.</li>
- *     <li>The code is built to be able to add more screens. For instance the systemlog-YYYY-MM-DD.txt file can be read and parsed to display the signal detection reports. The user could select between the component status screen and the latest signal detection reports. Support for adding this is already built in, follow the example of components.cpp. Create a new class like Components that uses Details as a base class and make it display and page through the signal reports that are continuall added to systemlog-YYYY-MM-DD.txt.</li>
- *     <li>The same for error reports, it would be good to create another screen that parses errorlog-YYYY-MM-DD.txt and distills the errors in another screen.</li>
  *     <li>Are there any curses programming experts that can help with the following:
  *       <ul>
  *         <li>Make sure this curses program works in any xterm? Some xterm programs use a different character set and drawing corners, boxes, etc. do not work. Is there a way to standardize to make it work everywhere?</li>
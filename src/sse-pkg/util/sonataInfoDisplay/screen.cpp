@@ -34,16 +34,16 @@
 
 #include "screen.h"
 #include "utils.h"
+#include "diagnostics.h"
 
 
 bool Screen::m_resizeEventOccurred = false;
 int Screen::m_newRows = -1;
 int Screen::m_newCols = -1;
+volatile sig_atomic_t Screen::m_finishRequested = 0;
 
-/** Define the bottom menu area to have no height. In future
- * versions we will add a bottom menu, increase this to "1".
- */
-#define BOTTOM_MENU_HEIGHT 0
+/** Define the bottom menu area to be one line high. */
+#define BOTTOM_MENU_HEIGHT 1
 
 /* Constructor. */
 Screen::Screen()
@@ -52,11 +52,14 @@ Screen::Screen()
     Screen::m_newRows = -1;
     Screen::m_newCols = -1;
     m_screenMode = screen_mode_components;
+    for(int i = 0; i < screen_mode_last; i++) m_details[i] = NULL;
     m_page = 1;
     m_isNewMode = false;
+    m_initialized = false;
     m_rows = m_newRows;
     m_cols = m_newCols;
     (void) signal(SIGINT, Screen::finish);         /* arrange interrupts to terminate */
+    (void) signal(SIGTERM, Screen::finish);
     (void) signal(SIGWINCH, Screen::screenResize); /* Catch the resize signal */
     m_rows = m_newRows;
     m_cols = m_newCols;
@@ -70,11 +73,13 @@ Screen::~Screen()
 }
 
 /*
- * Initialize the curses screen.
+ * Initialize the curses screen. Nothing is painted and no keys
+ * are read until this is called.
  */
 void Screen::init()
 {
     initscr();      /* initialize the curses library */
+    m_initialized = true;
     keypad(stdscr, TRUE);  /* enable keyboard mapping */
     (void) nonl();         /* tell curses not to do NL->CR/NL on output */
     (void) cbreak();       /* take input chars one at a time, no wait for \n */
@@ -129,14 +134,34 @@ void Screen::screenResize(int sig)
 }
 
 /*
- * Catch the control-c to quit screen mode then exit.
+ * Catch the control-c, or SIGTERM, and ask the main loop to
+ * quit. Nothing is closed here, as little is safe in a handler.
  *
  * @param sig the signal.
  */
-void Screen::finish(int sig)
+void Screen::finish(int)
 {
+    m_finishRequested = 1;
+}
+
+/*
+ * Check if SIGINT or SIGTERM has asked the program to quit.
+ *
+ * @return true if the main loop should stop.
+ */
+bool Screen::isFinishRequested()
+{
+    return m_finishRequested != 0;
+}
+
+/*
+ * Quit screen mode, if init() was called.
+ */
+void Screen::end()
+{
+    if(!m_initialized) return;
     endwin();
-    exit(0);
+    m_initialized = false;
 }
 
 /*
@@ -144,49 +169,86 @@ void Screen::finish(int sig)
  */
 void Screen::drawBottomMenu()
 {
+    static const char *labels[screen_mode_last] = {
+        "1-Status",
+        "2-Signals",
+        "3-Errors",
+        "4-Summary",
+        "5-Activity",
+        "6-History",
+        "7-Diag"
+    };
+
+    if(m_rows <= 0 || m_cols <= 0) return;
+
+    int count = 0;
+    for(int i = screen_mode_components; i<screen_mode_last; i++)
+        if(m_details[i] != NULL) count++;
+
+    string blank(m_cols, ' ');
+    move(m_rows-1, 0);
+    addstr(blank.c_str());
+
+    int centerPos = 0;
+    int width = m_cols/(count+1);
+    int item = 0;
+
+    for(int i = screen_mode_components; i<screen_mode_last; i++)
+    {
+        if(m_details[i] == NULL) continue;
 
-    /** @todo Multiple report screens need to be implemented. Until this is working
-     * the bottom menu should not be displayed.
-     */
-
-    /*
-       int centerPos = 0;
-       int width = (m_cols/(screen_mode_last - screen_mode_components +1));
+        item++;
+        centerPos = item*width;
+        if(m_screenMode == i) attrset(COLOR_PAIR(6)); //magenta
+        else attrset(COLOR_PAIR(5)); //cyan
 
-       for(int i = screen_mode_components; i<screen_mode_last; i++)
-       {
-       centerPos = (i+1)*width;
-       if(m_screenMode == i) attrset(COLOR_PAIR(6)); //magenta
-       else attrset(COLOR_PAIR(5)); //cyan
+        move(m_rows-1, centerPos - (int)strlen(labels[i])/2);
+        addstr(labels[i]);
 
-       if(i == screen_mode_components)
-       {
-       move(m_rows-1, centerPos - (int)strlen("1-Status")/2);
-       addstr("F1 - Status");
-       }
-       if(i == screen_mode_signals)
-       {
-       move(m_rows-1, centerPos - (int)strlen("2-Signals")/2);
-       addstr("F2 - Signals");
-       }
-       if(i == screen_mode_errors)
-       {
-       move(m_rows-1, centerPos - (int)strlen("2-Errors")/2);
-       addstr("F3 - Errors");
-       }
-       if(i == screen_mode_summary)
-       {
-       move(m_rows-1, centerPos - (int)strlen("4-Summary")/2);
-       addstr("F4 - Summary");
-       }
+        attrset(COLOR_PAIR(0));
+    }
 
-       attrset(COLOR_PAIR(0));
-       }
-     */
     return;
 
 }
 
+/*
+ * Set the Details object displayed in a screen mode. Only the
+ * modes that have a Details object are offered in the bottom
+ * menu.
+ *
+ * @param mode the screen mode.
+ * @param details the Details object to display in this mode.
+ */
+void Screen::setDetails(screen_modes_t mode, Details *details)
+{
+    m_details[mode] = details;
+}
+
+/*
+ * Switch to another screen mode, if it has a Details object.
+ *
+ * @param mode the screen mode.
+ */
+void Screen::setMode(screen_modes_t mode)
+{
+    if(m_details[mode] == NULL || mode == m_screenMode) return;
+
+    m_screenMode = mode;
+    m_isNewMode = true;
+    paint();
+}
+
+/*
+ * Paint the screen with the Details object of the current
+ * screen mode.
+ */
+void Screen::paint()
+{
+    if(m_details[m_screenMode] != NULL)
+        paint(m_details[m_screenMode]);
+}
+
 /*
  * paint the screen.
  *
@@ -198,6 +260,11 @@ void Screen::paint(Details *details)
     bool shouldRefresh = false;
     string line;
 
+    //Nothing to draw on until init() is called, e.g. when headless.
+    if(!m_initialized) return;
+
+    uint64_t start = Diagnostics::now();
+
     if(Screen::m_resizeEventOccurred == true)
     {
         Screen::m_resizeEventOccurred = false;
@@ -227,6 +294,10 @@ void Screen::paint(Details *details)
             shouldRefresh = true;
         }
     }
+    else
+    {
+        return;
+    }
 
     //Print the page
     line = "Page " + Utils::itos(m_page) + " of " + 
@@ -240,30 +311,43 @@ void Screen::paint(Details *details)
         line = "9=PgUp";
     else
         line = "8=PgDn, 9=PgUp";
+    //Pad on the left to blank out a longer hint, padding on the right
+    //would wrap onto the next line.
+    line.insert((size_t)0, strlen("8=PgDn, 9=PgUp") - line.size(), ' ');
     move(1, m_cols-line.size());
-    line += "     ";
     addstr(line.c_str() );
 
+    drawBottomMenu();
+
     //Park cursor
     move(m_rows-1, m_cols-1);
 
     if(shouldRefresh == true)
     {
+        for(int row = 0; row < m_rows; row++)
+        {
+            if(is_linetouched(stdscr, row))
+                Diagnostics::count(Diagnostics::counter_cells_touched, m_cols);
+        }
         refresh();
     }
 
+    Diagnostics::count(Diagnostics::counter_paints);
+    Diagnostics::record(Diagnostics::timing_paint, start);
+
 }
 
 /*
  * Process key presses.
- *
- * @param details the Details object to redraw of a key affects
- * the screen.
+ * The number keys (or function keys) switch between the screen
+ * modes, the page keys page through the current screen.
  */
-void Screen::processKey(Details *details)
+void Screen::processKey()
 {
     char key[5];
 
+    if(!m_initialized) return;
+
     int ch = getch();
 
     //Print the keypress in the lower left corner
@@ -279,37 +363,18 @@ void Screen::processKey(Details *details)
        }
      */
 
-    /** @todo Add multiple screens that change based on key presses. */
-    /*
-    if(ch == 49)
-    {
-    m_screenMode = screen_mode_components;
-    m_isNewMode = true;
-    drawBottomMenu();
-    refresh();
-    }
-    if(ch == 50)
-    {
-    m_screenMode = screen_mode_signals;
-    m_isNewMode = true;
-    drawBottomMenu();
-    refresh();
-    }
-    if(ch == 51)
+    //Switch screens with '1' to '7', or F1 to F7.
+    for(int i = screen_mode_components; i<screen_mode_last; i++)
     {
-    m_screenMode = screen_mode_errors;
-    m_isNewMode = true;
-    drawBottomMenu();
-    refresh();
-    }
-    if(ch == 52)
-    {
-    m_screenMode = screen_mode_summary;
-    m_isNewMode = true;
-    drawBottomMenu();
-    refresh();
+        if(ch == '1' + i || ch == KEY_F(1 + i))
+        {
+            setMode((screen_modes_t)i);
+            return;
+        }
     }
-     */
+
+    Details *details = m_details[m_screenMode];
+    if(details == NULL) return;
 
     //Decrement the page if the '8' key is pressed.
     if(ch == 56)
@@ -330,5 +395,12 @@ void Screen::processKey(Details *details)
         refresh();
     }
 
+    //Let the current screen handle any other key.
+    if(ch != ERR && ch != 56 && ch != 57 && details->processKey(ch))
+    {
+        paint(details);
+        refresh();
+    }
+
 
 }
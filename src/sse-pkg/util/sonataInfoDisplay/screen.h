@@ -63,7 +63,8 @@ class Screen
         ~Screen();
 
         /**
-         * Initialize the curses screen.
+         * Initialize the curses screen. Nothing is painted and no keys
+         * are read until this is called.
          */
         void init();
 
@@ -82,12 +83,25 @@ class Screen
         static void screenResize(int sig);
 
         /**
-         * Catch the control-c to quit screen mode then exit.
+         * Catch the control-c, or SIGTERM, and ask the main loop to
+         * quit. Nothing is closed here, as little is safe in a handler.
          *
          * @param sig the signal.
          */
         static void finish(int sig);
 
+        /**
+         * Check if SIGINT or SIGTERM has asked the program to quit.
+         *
+         * @return true if the main loop should stop.
+         */
+        static bool isFinishRequested();
+
+        /**
+         * Quit screen mode, if init() was called.
+         */
+        void end();
+
         /**
          * paint the screen.
          *
@@ -96,18 +110,23 @@ class Screen
          */
         void paint(Details *details);
 
+        /**
+         * Paint the screen with the Details object of the current
+         * screen mode.
+         */
+        void paint();
+
         /**
          * Process key presses.
-         * 
-         * @param details the Details object to redraw of a key affects 
-         * the screen.
+         * The number keys (or function keys) switch between the screen
+         * modes, the page keys page through the current screen.
          */
-        void processKey(Details *details);
+        void processKey();
 
         /**
-         * Define the different type of screen modes. Currently there
-         * is only support for the components screen, but more are to
-         * be added later.
+         * Define the different type of screen modes. The values line up
+         * with Details::detail_t so a Details object can be matched to
+         * its screen.
          */
         enum screen_modes_t
         {
@@ -115,13 +134,36 @@ class Screen
             screen_mode_signals,
             screen_mode_errors,
             screen_mode_summary,
+            screen_mode_activity,
+            screen_mode_history,
+            screen_mode_diagnostics,
             screen_mode_last
         };
 
+        /**
+         * Set the Details object displayed in a screen mode. Only the
+         * modes that have a Details object are offered in the bottom
+         * menu.
+         *
+         * @param mode the screen mode.
+         * @param details the Details object to display in this mode.
+         */
+        void setDetails(screen_modes_t mode, Details *details);
+
     private:
 
+        /**
+         * Switch to another screen mode, if it has a Details object.
+         *
+         * @param mode the screen mode.
+         */
+        void setMode(screen_modes_t mode);
+
+        Details *m_details[screen_mode_last];
+
         int m_cols;
         int m_rows;
+        bool m_initialized;
         bool m_isNewMode;
         int m_page;
         int m_curentPage;
@@ -130,6 +172,7 @@ class Screen
         static bool m_resizeEventOccurred;
         static int m_newCols;
         static int m_newRows;
+        static volatile sig_atomic_t m_finishRequested;
 
 };
 
@@ -0,0 +1,538 @@
+/*
+ * signals.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Reads and displays the signal reports in the system log.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file signals.cpp
+ * Reads and displays the signal reports in the system log.
+ */
+
+#include "signals.h"
+#include "componentstatus.h"
+#include "utils.h"
+#include <ncurses.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+/** Rows above the table: time and title, sort and filter, column headings. */
+#define SIGNALS_HEADER_ROWS 3
+
+/**
+ * Index values that are not signals. They stand for before the first
+ * and after the last signal with the filter value in
+ * Signals::m_probeValue, to find the range of a filter value.
+ */
+#define SIGNALS_PROBE_LOW  0xfffffffeU
+#define SIGNALS_PROBE_HIGH 0xffffffffU
+
+/*
+ * Constructor.
+ *
+ * @param owner the signals.
+ * @param filter a Signals::filter_t value.
+ * @param sort a Signals::sort_t value.
+ */
+SignalOrder::SignalOrder(const Signals *owner, int filter, int sort)
+{
+    m_owner = owner;
+    m_filter = filter;
+    m_sort = sort;
+}
+
+/*
+ * Compare two signal indices.
+ *
+ * @return true if a comes before b.
+ */
+bool SignalOrder::operator()(uint32_t a, uint32_t b) const
+{
+    bool aProbe = (a >= SIGNALS_PROBE_LOW);
+    bool bProbe = (b >= SIGNALS_PROBE_LOW);
+
+    uint32_t aValue = aProbe ? m_owner->m_probeValue :
+        Signals::getFilterValue(m_owner->m_signals[a], m_filter);
+    uint32_t bValue = bProbe ? m_owner->m_probeValue :
+        Signals::getFilterValue(m_owner->m_signals[b], m_filter);
+    if(aValue != bValue) return aValue < bValue;
+
+    if(aProbe || bProbe)
+    {
+        if(a == b) return false;
+        if(a == SIGNALS_PROBE_LOW || b == SIGNALS_PROBE_HIGH) return true;
+        return false;
+    }
+
+    const Signal &sa = m_owner->m_signals[a];
+    const Signal &sb = m_owner->m_signals[b];
+
+    if(m_sort == Signals::sort_class && sa.sigClass != sb.sigClass)
+        return sa.sigClass < sb.sigClass;
+    if(m_sort == Signals::sort_snr && sa.snr != sb.snr)
+        return sa.snr > sb.snr;
+    if(m_sort == Signals::sort_dx && sa.dx != sb.dx)
+        return m_owner->m_strings.get(sa.dx) < m_owner->m_strings.get(sb.dx);
+
+    if(sa.rfFreqMHz != sb.rfFreqMHz) return sa.rfFreqMHz < sb.rfFreqMHz;
+    return a < b;
+}
+
+/*
+ * Constructor.
+ */
+Signals::Signals() : Details()
+{
+    m_thisType = detail_signals;
+    m_activityId = -1;
+    m_filter = filter_none;
+    m_filterValue = 0;
+    m_probeValue = 0;
+    m_sort = sort_freq;
+    m_lastRequestedPage = -1;
+
+    for(int filter = 0; filter < filter_last; filter++)
+        for(int sort = 0; sort < sort_last; sort++)
+            m_index[filter][sort] = new Index(SignalOrder(this, filter, sort));
+}
+
+/*
+ * Destructor.
+ */
+Signals::~Signals()
+{
+    for(int filter = 0; filter < filter_last; filter++)
+        for(int sort = 0; sort < sort_last; sort++)
+            delete m_index[filter][sort];
+}
+
+/*
+ * Add a line read from the system log.
+ *
+ * @param line the line.
+ * @return true if it was a signal report, else false.
+ */
+bool Signals::addLine(const string &line)
+{
+    if(!Utils::startsWith("dx", line)) return false;
+
+    Signal signal;
+    memset(&signal, 0, sizeof(signal));
+    signal.activityId = -1;
+    signal.pol = pol_uninit;
+    signal.sigClass = class_uninit;
+
+    bool haveFreq = false;
+    bool haveClass = false;
+    string name = "";
+    string reason = "";
+
+    //Read the dx name then the field name and value pairs.
+    size_t start = line.find_first_not_of(" \t\r\n");
+    while(start != string::npos)
+    {
+        size_t end = line.find_first_of(" \t\r\n", start);
+        string word = line.substr(start, (end == string::npos) ? string::npos : end - start);
+        start = (end == string::npos) ? end : line.find_first_not_of(" \t\r\n", end);
+
+        if(name == "")
+        {
+            name = word;
+            continue;
+        }
+        if(start == string::npos) break;
+
+        end = line.find_first_of(" \t\r\n", start);
+        string value = line.substr(start, (end == string::npos) ? string::npos : end - start);
+
+        const char *field = word.c_str();
+        if(strcasecmp(field, "Act") == 0) signal.activityId = atoi(value.c_str());
+        else if(strcasecmp(field, "Sig") == 0) signal.number = (uint32_t)atol(value.c_str());
+        else if(strcasecmp(field, "Freq") == 0 || strcasecmp(field, "RfFreq") == 0)
+        {
+            haveFreq = Utils::parseFloat(value.data(), value.data() + value.size(),
+                    signal.rfFreqMHz);
+        }
+        else if(strcasecmp(field, "Pol") == 0) signal.pol = (uint8_t)parsePol(value);
+        else if(strcasecmp(field, "Drift") == 0) signal.drift = Utils::stof(value);
+        else if(strcasecmp(field, "Width") == 0) signal.width = Utils::stof(value);
+        else if(strcasecmp(field, "SNR") == 0) signal.snr = Utils::stof(value);
+        else if(strcasecmp(field, "Class") == 0)
+        {
+            signal.sigClass = (uint8_t)parseClass(value);
+            haveClass = true;
+        }
+        else if(strcasecmp(field, "Reason") == 0) reason = value;
+        else continue;
+
+        //Skip the value.
+        start = (end == string::npos) ? end : line.find_first_not_of(" \t\r\n", end);
+    }
+
+    if(!haveFreq || !haveClass) return false;
+
+    //A new activity starts the list again.
+    if(signal.activityId > m_activityId)
+    {
+        clearSignals();
+        m_activityId = signal.activityId;
+    }
+    else if(signal.activityId >= 0 && signal.activityId < m_activityId) return false;
+
+    signal.dx = m_strings.intern(name);
+    signal.reason = m_strings.intern(reason);
+
+    uint32_t index = (uint32_t)m_signals.size();
+    m_signals.push_back(signal);
+
+    for(int filter = 0; filter < filter_last; filter++)
+    {
+        m_counts[filter][getFilterValue(signal, filter)]++;
+        for(int sort = 0; sort < sort_last; sort++)
+            m_index[filter][sort]->insert(index);
+    }
+
+    return true;
+}
+
+/*
+ * Forget the signals of the last activity.
+ */
+void Signals::clearSignals()
+{
+    for(int filter = 0; filter < filter_last; filter++)
+    {
+        m_counts[filter].clear();
+        for(int sort = 0; sort < sort_last; sort++)
+            m_index[filter][sort]->clear();
+    }
+    m_signals.clear();
+}
+
+/*
+ * Get the value of the field a filter looks at.
+ *
+ * @param signal the signal.
+ * @param filter the filter_t.
+ * @return the value.
+ */
+uint32_t Signals::getFilterValue(const Signal &signal, int filter)
+{
+    if(filter == filter_class) return signal.sigClass;
+    if(filter == filter_pol) return signal.pol;
+    if(filter == filter_reason) return signal.reason;
+    return 0;
+}
+
+/*
+ * Parse a class word such as "Cand" or "CLASS_RFI".
+ *
+ * @return the class_t, class_uninit if not known.
+ */
+int Signals::parseClass(const string &word)
+{
+    const char *text = word.c_str();
+    if(strncasecmp(text, "CLASS_", 6) == 0) text += 6;
+
+    if(strncasecmp(text, "cand", 4) == 0) return class_cand;
+    if(strcasecmp(text, "rfi") == 0) return class_rfi;
+    if(strcasecmp(text, "test") == 0) return class_test;
+    if(strncasecmp(text, "unkn", 4) == 0) return class_unknown;
+
+    return class_uninit;
+}
+
+/*
+ * Parse a polarization word such as "R" or "Left".
+ *
+ * @return the pol_t, pol_uninit if not known.
+ */
+int Signals::parsePol(const string &word)
+{
+    const char *text = word.c_str();
+    if(strncasecmp(text, "POL_", 4) == 0) text += 4;
+
+    if(strcasecmp(text, "bothlinear") == 0) return pol_both_linear;
+    switch(toupper(text[0]))
+    {
+        case 'R': return pol_right;
+        case 'L': return pol_left;
+        case 'B': return pol_both;
+        case 'M': return pol_mixed;
+        case 'X': return pol_x;
+        case 'Y': return pol_y;
+        default:  return pol_uninit;
+    }
+}
+
+/*
+ * Get the name of a class.
+ */
+const char *Signals::className(int sigClass)
+{
+    static const char *names[class_last] = {
+        "-", "Cand", "RFI", "Test", "Unknown"
+    };
+
+    if(sigClass < 0 || sigClass >= class_last) return names[class_uninit];
+    return names[sigClass];
+}
+
+/*
+ * Get the name of a polarization.
+ */
+const char *Signals::polName(int pol)
+{
+    static const char *names[pol_last] = {
+        "R", "L", "B", "M", "-", "X", "Y", "XY"
+    };
+
+    if(pol < 0 || pol >= pol_last) return names[pol_uninit];
+    return names[pol];
+}
+
+/*
+ * Get the number of signals in the current activity.
+ *
+ * @return the number of signals.
+ */
+uint32_t Signals::size() const
+{
+    return (uint32_t)m_signals.size();
+}
+
+/*
+ * Get a signal.
+ *
+ * @param index the signal index, from 0 to size()-1.
+ * @return the signal.
+ */
+const Signal &Signals::getSignal(uint32_t index) const
+{
+    return m_signals[index];
+}
+
+/*
+ * Get the strings the signals refer to.
+ *
+ * @return the string pool.
+ */
+const StringPool &Signals::getStrings() const
+{
+    return m_strings;
+}
+
+/*
+ * Get the number of signals that pass the filter.
+ */
+uint32_t Signals::getSelectedCount() const
+{
+    if(m_filter == filter_none) return (uint32_t)m_signals.size();
+
+    map<uint32_t, uint32_t>::const_iterator it = m_counts[m_filter].find(m_filterValue);
+    return (it == m_counts[m_filter].end()) ? 0 : it->second;
+}
+
+/*
+ * Step the filter value of a filter to the next value that has
+ * signals, or back to no filter.
+ */
+void Signals::nextFilterValue(int filter)
+{
+    map<uint32_t, uint32_t>::const_iterator it;
+
+    if(m_filter != filter) it = m_counts[filter].begin();
+    else it = m_counts[filter].upper_bound(m_filterValue);
+
+    if(it == m_counts[filter].end())
+    {
+        m_filter = filter_none;
+        m_filterValue = 0;
+    }
+    else
+    {
+        m_filter = filter;
+        m_filterValue = it->first;
+    }
+}
+
+/*
+ * Display the information on the screen.
+ *
+ * @param pageNum the page number to display.
+ * @param pageCols the number of columns on the screen.
+ * @param pageRows the number of rows on the screen.
+ * @return true if screen has changed, else false.
+ */
+bool Signals::paint(int pageNum, int pageCols, int pageRows)
+{
+    static const char *sortNames[sort_last] = { "Freq", "Class", "SNR", "Dx" };
+    char tempLine[256];
+    string blank(pageCols, ' ');
+    string line;
+
+    if(pageNum > getNumPages(pageRows)) pageNum = getNumPages(pageRows);
+    m_lastRequestedPage = pageNum;
+
+    //Draw the header
+    string headerString = "SonATA Signals";
+    move(0,0);
+    addstr(blank.c_str());
+    move(0,0);
+    if(m_activityId >= 0)
+    {
+        snprintf(tempLine, sizeof(tempLine), "Activity: %d", (int)m_activityId);
+        addstr(tempLine);
+    }
+    Utils::drawColorText(0, pageCols/2 - headerString.size()/2, 3, headerString);
+
+    string filter = "All";
+    if(m_filter == filter_class) filter = string("Class ") + className(m_filterValue);
+    else if(m_filter == filter_pol) filter = string("Pol ") + polName(m_filterValue);
+    else if(m_filter == filter_reason) filter = "Reason " + m_strings.get(m_filterValue);
+
+    snprintf(tempLine, sizeof(tempLine),
+            "%u of %u. o=Sort: %s, c/p/r=Class/Pol/Reason: %s",
+            (unsigned int)getSelectedCount(), (unsigned int)m_signals.size(),
+            sortNames[m_sort], filter.c_str());
+    line = tempLine;
+    line.resize(pageCols, ' ');
+    move(1,0);
+    addstr(line.c_str());
+
+    snprintf(tempLine, sizeof(tempLine), "%-7s %5s %15s %3s %8s %7s %7s %-7s %s",
+            "Dx", "Sig", "RF Freq MHz", "Pol", "Drift", "Width", "SNR", "Class", "Reason");
+    line = tempLine;
+    line.resize(pageCols, ' ');
+    Utils::drawColorText(2, 0, 2, line);
+
+    //The range of the filter value in the index for the filter and sort.
+    Index &index = *m_index[m_filter][m_sort];
+    Index::const_iterator it = index.begin();
+    Index::const_iterator last = index.end();
+    if(m_filter != filter_none)
+    {
+        m_probeValue = m_filterValue;
+        it = index.lower_bound(SIGNALS_PROBE_LOW);
+        last = index.upper_bound(SIGNALS_PROBE_HIGH);
+    }
+
+    int realRows = pageRows - SIGNALS_HEADER_ROWS;
+    for(int skip = (pageNum-1) * realRows; skip > 0 && it != last; skip--) it++;
+
+    for(int i = 0; i < realRows; i++)
+    {
+        int row = SIGNALS_HEADER_ROWS + i;
+
+        move(row, 0);
+        addstr(blank.c_str());
+        if(it == last) continue;
+
+        const Signal &signal = m_signals[*it];
+        it++;
+
+        snprintf(tempLine, sizeof(tempLine),
+                "%-7s %5u %15.6f %3s %8.3f %7.1f %7.1f %-7s %s",
+                m_strings.get(signal.dx).c_str(), (unsigned int)signal.number,
+                signal.rfFreqMHz, polName(signal.pol), signal.drift,
+                signal.width, signal.snr, className(signal.sigClass),
+                m_strings.get(signal.reason).c_str());
+        line = tempLine;
+        line.resize(pageCols, ' ');
+
+        if(signal.sigClass == class_cand) Utils::drawColorText(row, 0, 2, line);
+        else
+        {
+            move(row, 0);
+            addstr(line.c_str());
+        }
+    }
+
+    //Park the cursor in the lower right corner
+    move(pageRows-1, pageCols-1);
+
+    return true;
+}
+
+/*
+ * Handle a key press to change the sort order or filter.
+ *
+ * @param ch the key, as returned by getch().
+ * @return true if the screen should be repainted, else false.
+ */
+bool Signals::processKey(int ch)
+{
+    if(ch == 'o')
+    {
+        m_sort = (m_sort + 1) % sort_last;
+    }
+    else if(ch == 'c') nextFilterValue(filter_class);
+    else if(ch == 'p') nextFilterValue(filter_pol);
+    else if(ch == 'r') nextFilterValue(filter_reason);
+    else return false;
+
+    return true;
+}
+
+/*
+ * Get the number of pages required to display all the information.
+ *
+ * @param pageRows the number of rows available on the screen.
+ * @return the number of pages required to display all the
+ * information.
+ */
+int Signals::getNumPages(int pageRows)
+{
+    int realRows = pageRows - SIGNALS_HEADER_ROWS;
+    if(realRows < 1) return 1;
+
+    int rows = (int)getSelectedCount();
+    if(rows < 1) return 1;
+    return (rows - 1) / realRows + 1;
+}
+
+/*
+ * Get the type of this object inherited from the Details class.
+ *
+ * @return the type as a detail_t enum value.
+ */
+int Signals::getType()
+{
+    return m_thisType;
+}
+
+/*
+ * Get the current page number displayed.
+ *
+ * @return the current page number displayed.
+ */
+int Signals::getCurrentPageNumber()
+{
+    if(m_lastRequestedPage <= 0) return 1;
+    return m_lastRequestedPage;
+}
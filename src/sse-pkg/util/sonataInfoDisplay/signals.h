@@ -0,0 +1,334 @@
+/*
+ * signals.h
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Reads and displays the signal reports in the system log.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file signals.h
+ * Reads and displays the signal reports in the system log.
+ */
+
+#ifndef SIGNALS_H
+#define SIGNALS_H
+
+#include "details.h"
+#include "stringpool.h"
+#include <set>
+
+using namespace std;
+
+/**
+ * One signal reported by a dx. The strings are ids in the Signals
+ * string pool.
+ */
+struct Signal
+{
+    /** The RF frequency, MHz. */
+    double rfFreqMHz;
+    /** The drift, Hz/s. */
+    float drift;
+    /** The width, Hz. */
+    float width;
+    /** The signal to noise ratio. */
+    float snr;
+    /** The activity id. */
+    int32_t activityId;
+    /** The signal number within the activity. */
+    uint32_t number;
+    /** The dx name. */
+    uint32_t dx;
+    /** The classification reason, e.g. "Confirm". */
+    uint32_t reason;
+    /** A Signals::class_t value. */
+    uint8_t sigClass;
+    /** A Signals::pol_t value. */
+    uint8_t pol;
+};
+
+class Signals;
+
+/**
+ * Orders signal indices for one filter and sort order: first by the
+ * filtered field, so each filter value is a contiguous range, then by
+ * the sort order, then by index.
+ */
+class SignalOrder
+{
+    public:
+
+        /**
+         * Constructor.
+         *
+         * @param owner the signals.
+         * @param filter a Signals::filter_t value.
+         * @param sort a Signals::sort_t value.
+         */
+        SignalOrder(const Signals *owner, int filter, int sort);
+
+        /**
+         * Compare two signal indices.
+         *
+         * @return true if a comes before b.
+         */
+        bool operator()(uint32_t a, uint32_t b) const;
+
+    private:
+
+        const Signals *m_owner;
+        int m_filter;
+        int m_sort;
+};
+
+/**
+ * Reads the signal reports from "systemlog-YYYY-MM-DD.txt" and displays
+ * the signals of the current activity.
+ *
+ * A signal report is a line that starts with the dx name and then has
+ * pairs of field name and value, in any order, e.g.
+ *
+ * dx1003 Act 2735 Sig 12 Freq 1420.123456 Pol R Drift 0.12 Width 1.0
+ * SNR 54.3 Class Cand Reason Confirm
+ *
+ * Freq and Class are needed, the other fields may be left out. Other
+ * lines are ignored. A signal from a newer activity starts the list
+ * again.
+ *
+ * Each signal is inserted into an index for every pair of filter
+ * (none, class, polarization, reason) and sort order (frequency; class,
+ * snr or dx then frequency). Each index is ordered by the filtered
+ * field first, so changing the sort or the filter picks another index
+ * and finds the range with a binary search, and nothing is ever sorted
+ * again. Keeping the 16 indices costs O(log n) per signal.
+ *
+ * Keys: 'o' cycles the sort order. 'c', 'p' and 'r' cycle the signals
+ * shown by class, polarization or reason, one filter at a time.
+ *
+ * Inherits from the Details class.
+ */
+class Signals: public Details
+{
+    public:
+
+        /** The classes. The values match SignalClass in ssePdmInterface.h. */
+        enum class_t
+        {
+            class_uninit,
+            class_cand,
+            class_rfi,
+            class_test,
+            class_unknown,
+            class_last
+        };
+
+        /** The polarizations. The values match Polarization in sseInterface.h. */
+        enum pol_t
+        {
+            pol_right,
+            pol_left,
+            pol_both,
+            pol_mixed,
+            pol_uninit,
+            pol_x,
+            pol_y,
+            pol_both_linear,
+            pol_last
+        };
+
+        /** The filters. */
+        enum filter_t
+        {
+            filter_none,
+            filter_class,
+            filter_pol,
+            filter_reason,
+            filter_last
+        };
+
+        /** The sort orders. */
+        enum sort_t
+        {
+            sort_freq,
+            sort_class,
+            sort_snr,
+            sort_dx,
+            sort_last
+        };
+
+        /** Constructor. */
+        Signals();
+
+        /** Destructor. */
+        ~Signals();
+
+        /**
+         * Add a line read from the system log.
+         *
+         * @param line the line.
+         * @return true if it was a signal report, else false.
+         */
+        bool addLine(const string &line);
+
+        /**
+         * Get the number of signals in the current activity.
+         *
+         * @return the number of signals.
+         */
+        uint32_t size() const;
+
+        /**
+         * Get a signal.
+         *
+         * @param index the signal index, from 0 to size()-1.
+         * @return the signal.
+         */
+        const Signal &getSignal(uint32_t index) const;
+
+        /**
+         * Get the strings the signals refer to.
+         *
+         * @return the string pool.
+         */
+        const StringPool &getStrings() const;
+
+        /**
+         * Get the value of the field a filter looks at.
+         *
+         * @param signal the signal.
+         * @param filter the filter_t.
+         * @return the value.
+         */
+        static uint32_t getFilterValue(const Signal &signal, int filter);
+
+        /**
+         * Parse a class word such as "Cand" or "CLASS_RFI".
+         *
+         * @return the class_t, class_uninit if not known.
+         */
+        static int parseClass(const string &word);
+
+        /**
+         * Parse a polarization word such as "R" or "Left".
+         *
+         * @return the pol_t, pol_uninit if not known.
+         */
+        static int parsePol(const string &word);
+
+        /** Get the name of a class. */
+        static const char *className(int sigClass);
+
+        /** Get the name of a polarization. */
+        static const char *polName(int pol);
+
+        /**
+         * Get the number of pages required to display all the information.
+         *
+         * @param pageRows the number of rows available on the screen.
+         * @return the number of pages required to display all the
+         * information.
+         */
+        int getNumPages(int pageRows);
+
+        /**
+         * Get the type of this object inherited from the Details class.
+         *
+         * @return the type as a detail_t enum value.
+         */
+        int getType();
+
+        /**
+         * Get the current page number displayed.
+         *
+         * @return the current page number displayed.
+         */
+        int getCurrentPageNumber();
+
+        /**
+         * Display the information on the screen.
+         *
+         * @param pageNum the page number to display.
+         * @param pageCols the number of columns on the screen.
+         * @param pageRows the number of rows on the screen.
+         * @return true if screen has changed, else false.
+         */
+        bool paint(int pageNum, int pageCols, int pageRows);
+
+        /**
+         * Handle a key press to change the sort order or filter.
+         *
+         * @param ch the key, as returned by getch().
+         * @return true if the screen should be repainted, else false.
+         */
+        bool processKey(int ch);
+
+    private:
+
+        friend class SignalOrder;
+
+        typedef multiset<uint32_t, SignalOrder> Index;
+
+        /** Not copyable, the indices point back at this object. */
+        Signals(const Signals &);
+        Signals &operator=(const Signals &);
+
+        /**
+         * Forget the signals of the last activity.
+         */
+        void clearSignals();
+
+        /**
+         * Get the number of signals that pass the filter.
+         */
+        uint32_t getSelectedCount() const;
+
+        /**
+         * Step the filter value of a filter to the next value that has
+         * signals, or back to no filter.
+         */
+        void nextFilterValue(int filter);
+
+        vector<Signal> m_signals;
+        StringPool m_strings;
+        int32_t m_activityId;
+
+        /** The indices, by filter_t and sort_t. */
+        Index *m_index[filter_last][sort_last];
+
+        /** The number of signals with each value of each filtered field. */
+        map<uint32_t, uint32_t> m_counts[filter_last];
+
+        int m_filter;
+        uint32_t m_filterValue;
+
+        /** The filter value the range probes of SignalOrder stand for. */
+        mutable uint32_t m_probeValue;
+
+        int m_sort;
+        int m_lastRequestedPage;
+};
+
+#endif //SIGNALS_H
+
@@ -0,0 +1,556 @@
+/*
+ * statusarchive.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * A compressed long term archive of status records.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file statusarchive.cpp
+ * A compressed long term archive of status records.
+ */
+
+#include "statusarchive.h"
+#include <string.h>
+#include <zlib.h>
+
+/** Stands for the record time in the lines of a record. */
+#define ARCHIVE_TIME_MARK '\001'
+
+/** Set in the length of a row whose text has the time marked. */
+#define ARCHIVE_ROW_MARKED 0x8000
+
+/** The bits of the length of a row that hold the length. */
+#define ARCHIVE_ROW_LENGTH 0x7fff
+
+/**
+ * The header of one record inside a block. It is followed by count
+ * rows, each a uint16_t line index, a uint16_t length and the text.
+ */
+struct ArchiveRecord
+{
+    /** The UTC time of the record, seconds since 1/1/70. */
+    int32_t timestamp;
+    /** The current activity id, -1 if none. */
+    int32_t activityId;
+    /** The lowest sky frequency of the dxs with a channel, MHz. */
+    float minDxFreqMHz;
+    /** The highest sky frequency of the dxs with a channel, MHz. */
+    float maxDxFreqMHz;
+    /** The number of rows that follow. */
+    uint16_t count;
+    /** 1 if the rows are every line, 0 if only the changed ones. */
+    uint8_t keyframe;
+    /** 0. */
+    uint8_t reserved;
+};
+
+/*
+ * Format a record time as it is written in the status lines.
+ */
+static void formatTime(time_t recordTime, char *text, size_t size)
+{
+    struct tm t;
+
+    gmtime_r(&recordTime, &t);
+    strftime(text, size, "%Y-%m-%d %H:%M:%S", &t);
+}
+
+/*
+ * Copy a line with each record time in it replaced by
+ * ARCHIVE_TIME_MARK. A line that already holds the mark is copied
+ * as it is. Returns true if the time was marked.
+ */
+static bool markTime(const string &line, const char *timeText, string &marked)
+{
+    marked = line;
+    if(marked.find(ARCHIVE_TIME_MARK) != string::npos) return false;
+
+    size_t length = strlen(timeText);
+    size_t pos = marked.find(timeText);
+    if(pos == string::npos) return false;
+
+    while(pos != string::npos)
+    {
+        marked.replace(pos, length, 1, ARCHIVE_TIME_MARK);
+        pos = marked.find(timeText, pos + 1);
+    }
+
+    return true;
+}
+
+/*
+ * Get the length of the component name at the start of a line.
+ */
+static size_t nameLength(const string &line)
+{
+    size_t length = line.find_first_of(" \t");
+    return (length == string::npos) ? line.size() : length;
+}
+
+/* Constructor. */
+StatusArchive::StatusArchive()
+{
+    m_fp = NULL;
+    m_indexFp = NULL;
+    m_writing = false;
+    m_blockRecords = 0;
+    m_blockFirstTime = 0;
+    m_blockStarted = 0;
+    m_loadedBlock = -1;
+}
+
+/* Destructor. Writes the last block and closes the archive. */
+StatusArchive::~StatusArchive()
+{
+    close();
+}
+
+/*
+ * Open an archive to write records to. Records are appended.
+ *
+ * @param filename the name of the archive.
+ * @return true if the archive and its index are open, else false.
+ */
+bool StatusArchive::create(const string &filename)
+{
+    close();
+
+    m_fp = fopen(filename.c_str(), "ab");
+    m_indexFp = fopen((filename + STATUS_ARCHIVE_INDEX_SUFFIX).c_str(), "ab");
+    if(m_fp == NULL || m_indexFp == NULL)
+    {
+        close();
+        return false;
+    }
+
+    m_writing = true;
+    return true;
+}
+
+/*
+ * Append a record.
+ *
+ * @param header the record header.
+ * @param lines the text of the lines of the record, see
+ * Components::getRecordText().
+ * @return true if written, else false.
+ */
+bool StatusArchive::write(const StatusFeedHeader &header, const vector<string> &lines)
+{
+    if(!m_writing || lines.size() > 0xffff) return false;
+    if(!flushOld()) return false;
+
+    if(m_blockRecords >= STATUS_ARCHIVE_BLOCK_RECORDS ||
+            (m_blockRecords > 0 && header.timestamp - m_blockFirstTime >=
+             STATUS_ARCHIVE_BLOCK_SECONDS) ||
+            (m_blockRecords > 0 && !sameComponents(lines)))
+    {
+        if(!flush()) return false;
+    }
+
+    ArchiveRecord entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.timestamp = header.timestamp;
+    entry.activityId = header.activityId;
+    entry.minDxFreqMHz = header.minDxFreqMHz;
+    entry.maxDxFreqMHz = header.maxDxFreqMHz;
+    entry.keyframe = (m_blockRecords == 0);
+
+    if(entry.keyframe)
+    {
+        m_last.assign(lines.size(), string());
+        m_lastMarked.assign(lines.size(), 0);
+    }
+
+    //The count is filled in once the rows are known.
+    size_t start = m_block.size();
+    m_block.append((const char *)&entry, sizeof(entry));
+
+    char timeText[32];
+    formatTime(header.timestamp, timeText, sizeof(timeText));
+    for(int i = 0; i < (int)lines.size(); i++)
+    {
+        char marked = markTime(lines[i], timeText, m_marked) ? 1 : 0;
+        if(m_marked.size() > ARCHIVE_ROW_LENGTH) m_marked.resize(ARCHIVE_ROW_LENGTH);
+        if(!entry.keyframe && marked == m_lastMarked[i] && m_marked == m_last[i]) continue;
+
+        uint16_t index = (uint16_t)i;
+        uint16_t length = (uint16_t)m_marked.size();
+        if(marked) length |= ARCHIVE_ROW_MARKED;
+        m_block.append((const char *)&index, sizeof(index));
+        m_block.append((const char *)&length, sizeof(length));
+        m_block.append(m_marked);
+        m_last[i] = m_marked;
+        m_lastMarked[i] = marked;
+        entry.count++;
+    }
+    memcpy(&m_block[start], &entry, sizeof(entry));
+
+    if(entry.keyframe)
+    {
+        m_blockFirstTime = header.timestamp;
+        m_blockStarted = time(NULL);
+    }
+    m_blockRecords++;
+    m_lastHeader = header;
+
+    return true;
+}
+
+/*
+ * Write the block being filled, if it has any records.
+ *
+ * @return true if written, else false.
+ */
+bool StatusArchive::flush()
+{
+    if(!m_writing) return false;
+    if(m_blockRecords == 0) return true;
+
+    uLongf size = compressBound(m_block.size());
+    m_compressed.resize(size);
+    if(compress2((Bytef *)&m_compressed[0], &size, (const Bytef *)m_block.data(),
+                m_block.size(), Z_DEFAULT_COMPRESSION) != Z_OK)
+        return false;
+
+    StatusArchiveBlock block;
+    memcpy(block.magic, STATUS_ARCHIVE_MAGIC, sizeof(block.magic));
+    block.version = STATUS_ARCHIVE_VERSION;
+    block.reserved = 0;
+    block.firstTime = m_blockFirstTime;
+    block.lastTime = m_lastHeader.timestamp;
+    block.recordCount = m_blockRecords;
+    block.rawSize = (uint32_t)m_block.size();
+    block.compressedSize = (uint32_t)size;
+
+    StatusArchiveIndexEntry entry;
+    fseeko(m_fp, 0, SEEK_END);
+    entry.firstTime = block.firstTime;
+    entry.lastTime = block.lastTime;
+    entry.offset = (uint64_t)ftello(m_fp);
+
+    m_block.clear();
+    m_blockRecords = 0;
+
+    //The block goes first so the index never points past the archive.
+    if(fwrite(&block, sizeof(block), 1, m_fp) != 1 ||
+            fwrite(m_compressed.data(), size, 1, m_fp) != 1 ||
+            fflush(m_fp) != 0)
+        return false;
+
+    if(fwrite(&entry, sizeof(entry), 1, m_indexFp) != 1 || fflush(m_indexFp) != 0)
+        return false;
+
+    return true;
+}
+
+/*
+ * Write the block being filled if it was started
+ * STATUS_ARCHIVE_FLUSH_SECONDS or more ago, so a quiet status
+ * file does not hold records back.
+ *
+ * @return true if written or not yet due, else false.
+ */
+bool StatusArchive::flushOld()
+{
+    if(!m_writing) return false;
+    if(m_blockRecords == 0 || time(NULL) - m_blockStarted < STATUS_ARCHIVE_FLUSH_SECONDS)
+        return true;
+
+    return flush();
+}
+
+/*
+ * Open an archive to read from and load its index.
+ *
+ * @param filename the name of the archive.
+ * @return true if the archive is open, else false.
+ */
+bool StatusArchive::open(const string &filename)
+{
+    close();
+
+    m_fp = fopen(filename.c_str(), "rb");
+    if(m_fp == NULL) return false;
+
+    FILE *indexFp = fopen((filename + STATUS_ARCHIVE_INDEX_SUFFIX).c_str(), "rb");
+    if(indexFp != NULL)
+    {
+        StatusArchiveIndexEntry entry;
+        while(fread(&entry, sizeof(entry), 1, indexFp) == 1) m_index.push_back(entry);
+        fclose(indexFp);
+    }
+
+    //Pick up any blocks written after the index, or all of them if
+    //there is no index.
+    uint64_t next = 0;
+    if(!m_index.empty())
+    {
+        StatusArchiveBlock block;
+        uint64_t last = m_index.back().offset;
+        if(fseeko(m_fp, (off_t)last, SEEK_SET) == 0 &&
+                fread(&block, sizeof(block), 1, m_fp) == 1 &&
+                memcmp(block.magic, STATUS_ARCHIVE_MAGIC, sizeof(block.magic)) == 0)
+        {
+            next = last + sizeof(block) + block.compressedSize;
+        }
+        else m_index.clear();
+    }
+    scanBlocks(next);
+
+    return true;
+}
+
+/*
+ * Read the last record at or before a time.
+ *
+ * @param recordTime the UTC time, seconds since 1/1/70.
+ * @param header set to the record header.
+ * @param lines set to the text of the lines of the record.
+ * @return true if found, false if the time is before the
+ * archive or the block cannot be read.
+ */
+bool StatusArchive::read(time_t recordTime, StatusFeedHeader &header, vector<string> &lines)
+{
+    if(m_fp == NULL || m_writing) return false;
+
+    //The last block that starts at or before the time.
+    int low = 0;
+    int high = (int)m_index.size();
+    while(low < high)
+    {
+        int middle = (low + high) / 2;
+        if(m_index[middle].firstTime <= recordTime) low = middle + 1;
+        else high = middle;
+    }
+    if(low == 0 || !loadBlock(low - 1)) return false;
+
+    //Apply the records of the block up to the time. The first is a
+    //keyframe at or before it.
+    const char *data = m_block.data();
+    const char *end = data + m_block.size();
+    bool found = false;
+    while(data + sizeof(ArchiveRecord) <= end)
+    {
+        ArchiveRecord entry;
+        memcpy(&entry, data, sizeof(entry));
+        if(found && entry.timestamp > recordTime) break;
+        if(!found && !entry.keyframe) return false;
+        data += sizeof(entry);
+
+        if(entry.keyframe)
+        {
+            m_last.assign(entry.count, string());
+            m_lastMarked.assign(entry.count, 0);
+        }
+
+        for(int i = 0; i < entry.count; i++)
+        {
+            uint16_t index;
+            uint16_t length;
+            if(data + sizeof(index) + sizeof(length) > end) return false;
+            memcpy(&index, data, sizeof(index));
+            memcpy(&length, data + sizeof(index), sizeof(length));
+            data += sizeof(index) + sizeof(length);
+
+            char marked = (length & ARCHIVE_ROW_MARKED) ? 1 : 0;
+            length &= ARCHIVE_ROW_LENGTH;
+            if(index >= m_last.size() || data + length > end) return false;
+            m_last[index].assign(data, length);
+            m_lastMarked[index] = marked;
+            data += length;
+        }
+
+        header = StatusFeedHeader();
+        header.timestamp = entry.timestamp;
+        header.activityId = entry.activityId;
+        header.minDxFreqMHz = entry.minDxFreqMHz;
+        header.maxDxFreqMHz = entry.maxDxFreqMHz;
+        found = true;
+    }
+    if(!found) return false;
+
+    //Put the record time back in the lines that had it.
+    char timeText[32];
+    formatTime(header.timestamp, timeText, sizeof(timeText));
+    lines.resize(m_last.size());
+    for(int i = 0; i < (int)m_last.size(); i++)
+    {
+        lines[i] = m_last[i];
+        if(!m_lastMarked[i]) continue;
+        size_t pos = lines[i].find(ARCHIVE_TIME_MARK);
+        while(pos != string::npos)
+        {
+            lines[i].replace(pos, 1, timeText);
+            pos = lines[i].find(ARCHIVE_TIME_MARK, pos + 1);
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Get the number of blocks in the archive being read.
+ *
+ * @return the number of blocks.
+ */
+int StatusArchive::getBlockCount() const
+{
+    return (int)m_index.size();
+}
+
+/*
+ * Get the time of the first record in the archive being read.
+ *
+ * @return the time, 0 if the archive is empty.
+ */
+time_t StatusArchive::getFirstTime() const
+{
+    return m_index.empty() ? 0 : m_index[0].firstTime;
+}
+
+/*
+ * Get the time of the last record in the archive being read.
+ *
+ * @return the time, 0 if the archive is empty.
+ */
+time_t StatusArchive::getLastTime() const
+{
+    return m_index.empty() ? 0 : m_index.back().lastTime;
+}
+
+/*
+ * Write the last block and close the archive.
+ */
+void StatusArchive::close()
+{
+    if(m_writing) flush();
+
+    if(m_fp != NULL) fclose(m_fp);
+    if(m_indexFp != NULL) fclose(m_indexFp);
+    m_fp = NULL;
+    m_indexFp = NULL;
+    m_writing = false;
+
+    m_block.clear();
+    m_blockRecords = 0;
+    m_last.clear();
+    m_lastMarked.clear();
+    m_lastHeader = StatusFeedHeader();
+    m_index.clear();
+    m_loadedBlock = -1;
+}
+
+/*
+ * Check if the lines of a record start with the same component
+ * names, in the same order, as those of the last record.
+ *
+ * @param lines the text of the lines of the record.
+ * @return true if they are the same.
+ */
+bool StatusArchive::sameComponents(const vector<string> &lines)
+{
+    if(lines.size() != m_last.size()) return false;
+
+    for(int i = 0; i < (int)lines.size(); i++)
+    {
+        size_t length = nameLength(lines[i]);
+        if(length != nameLength(m_last[i]) ||
+                lines[i].compare(0, length, m_last[i], 0, length) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ * Read the block headers from an offset to the end of the archive
+ * and add them to the index.
+ *
+ * @param offset the offset of the first block header.
+ */
+void StatusArchive::scanBlocks(uint64_t offset)
+{
+    StatusArchiveBlock block;
+
+    if(fseeko(m_fp, 0, SEEK_END) != 0) return;
+    uint64_t size = (uint64_t)ftello(m_fp);
+
+    //Stop at anything that is not a whole block, such as a block
+    //still being written.
+    while(offset + sizeof(block) <= size)
+    {
+        if(fseeko(m_fp, (off_t)offset, SEEK_SET) != 0 ||
+                fread(&block, sizeof(block), 1, m_fp) != 1 ||
+                memcmp(block.magic, STATUS_ARCHIVE_MAGIC, sizeof(block.magic)) != 0 ||
+                offset + sizeof(block) + block.compressedSize > size)
+            break;
+
+        StatusArchiveIndexEntry entry;
+        entry.firstTime = block.firstTime;
+        entry.lastTime = block.lastTime;
+        entry.offset = offset;
+        m_index.push_back(entry);
+
+        offset += sizeof(block) + block.compressedSize;
+    }
+}
+
+/*
+ * Read and uncompress a block into m_block.
+ *
+ * @param index the index of the block in m_index.
+ * @return true if read, else false.
+ */
+bool StatusArchive::loadBlock(int index)
+{
+    StatusArchiveBlock block;
+
+    if(index == m_loadedBlock) return true;
+    m_loadedBlock = -1;
+
+    if(fseeko(m_fp, (off_t)m_index[index].offset, SEEK_SET) != 0 ||
+            fread(&block, sizeof(block), 1, m_fp) != 1 ||
+            memcmp(block.magic, STATUS_ARCHIVE_MAGIC, sizeof(block.magic)) != 0 ||
+            block.version != STATUS_ARCHIVE_VERSION)
+        return false;
+
+    m_compressed.resize(block.compressedSize);
+    if(block.compressedSize > 0 &&
+            fread(&m_compressed[0], block.compressedSize, 1, m_fp) != 1)
+        return false;
+
+    uLongf size = block.rawSize;
+    m_block.resize(block.rawSize);
+    if(block.rawSize == 0 ||
+            uncompress((Bytef *)&m_block[0], &size, (const Bytef *)m_compressed.data(),
+                block.compressedSize) != Z_OK ||
+            size != block.rawSize)
+        return false;
+
+    m_loadedBlock = index;
+    return true;
+}
@@ -0,0 +1,287 @@
+/*
+ * statusarchive.h
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * A compressed long term archive of status records.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file statusarchive.h
+ * A compressed long term archive of status records.
+ */
+
+#ifndef STATUSARCHIVE_H
+#define STATUSARCHIVE_H
+
+#include "statusfeed.h"
+#include <stdio.h>
+#include <time.h>
+
+using namespace std;
+
+/** The first 4 bytes of every block in a status archive. */
+#define STATUS_ARCHIVE_MAGIC "SSA\n"
+
+/** The version of the status archive format. Version 1 kept the
+ * parsed fields of each component instead of the text. */
+#define STATUS_ARCHIVE_VERSION 2
+
+/** The most records in a block. */
+#define STATUS_ARCHIVE_BLOCK_RECORDS 600
+
+/** The most seconds of record time in a block. */
+#define STATUS_ARCHIVE_BLOCK_SECONDS 300
+
+/** The most seconds of wall clock a block is kept unwritten, all that
+ * is lost if the display dies without close(). */
+#define STATUS_ARCHIVE_FLUSH_SECONDS 60
+
+/** Appended to the archive name for the name of its index. */
+#define STATUS_ARCHIVE_INDEX_SUFFIX ".idx"
+
+/**
+ * The header of one block of a status archive, followed by
+ * compressedSize bytes of zlib data. Written in host byte order.
+ */
+struct StatusArchiveBlock
+{
+    /** STATUS_ARCHIVE_MAGIC. */
+    char magic[4];
+    /** STATUS_ARCHIVE_VERSION. */
+    uint16_t version;
+    /** 0. */
+    uint16_t reserved;
+    /** The time of the first record, seconds since 1/1/70. */
+    int32_t firstTime;
+    /** The time of the last record, seconds since 1/1/70. */
+    int32_t lastTime;
+    /** The number of records in the block. */
+    uint32_t recordCount;
+    /** The size of the records once uncompressed. */
+    uint32_t rawSize;
+    /** The size of the zlib data that follows. */
+    uint32_t compressedSize;
+};
+
+/**
+ * One entry of a status archive index, one per block.
+ */
+struct StatusArchiveIndexEntry
+{
+    /** The time of the first record of the block. */
+    int32_t firstTime;
+    /** The time of the last record of the block. */
+    int32_t lastTime;
+    /** The offset of the StatusArchiveBlock in the archive. */
+    uint64_t offset;
+};
+
+/**
+ * A compressed long term archive of status records, to keep months of
+ * "sse-system-status.txt" for post-mortems.
+ *
+ * Each record is kept as the text of its lines, from the "NSS" header
+ * up to the "=====" line, so a record read back is the text that was
+ * in the file. The records are grouped into blocks of up to
+ * STATUS_ARCHIVE_BLOCK_RECORDS records or STATUS_ARCHIVE_BLOCK_SECONDS
+ * seconds. The first record of a block is a keyframe holding every
+ * line; each of the others holds only the lines that changed from the
+ * record before. The record time in a line is stored as a mark, so a
+ * line whose time simply follows the record time, or stays put, is not
+ * a change. A new block is also started when the lines no longer start
+ * with the same component names. Each block is compressed with zlib,
+ * and the time range and offset of each block is appended to an index
+ * file named after the archive with STATUS_ARCHIVE_INDEX_SUFFIX.
+ *
+ * To find the record at a time the reader binary searches the index,
+ * reads and uncompresses the one block and applies its records up to
+ * the time, so how long the archive is makes no difference. An index
+ * that is missing or behind the archive is made up from the block
+ * headers.
+ *
+ * Records are expected in time order. The block being filled is written by flush()
+ * or close(), when it is full, and by flushOld() once it has been kept
+ * for STATUS_ARCHIVE_FLUSH_SECONDS.
+ */
+class StatusArchive
+{
+    public:
+
+        /** Constructor. */
+        StatusArchive();
+
+        /** Destructor. Writes the last block and closes the archive. */
+        ~StatusArchive();
+
+        /**
+         * Open an archive to write records to. Records are appended.
+         *
+         * @param filename the name of the archive.
+         * @return true if the archive and its index are open, else false.
+         */
+        bool create(const string &filename);
+
+        /**
+         * Append a record.
+         *
+         * @param header the record header.
+         * @param lines the text of the lines of the record, see
+         * Components::getRecordText().
+         * @return true if written, else false.
+         */
+        bool write(const StatusFeedHeader &header, const vector<string> &lines);
+
+        /**
+         * Write the block being filled, if it has any records.
+         *
+         * @return true if written, else false.
+         */
+        bool flush();
+
+        /**
+         * Write the block being filled if it was started
+         * STATUS_ARCHIVE_FLUSH_SECONDS or more ago, so a quiet status
+         * file does not hold records back.
+         *
+         * @return true if written or not yet due, else false.
+         */
+        bool flushOld();
+
+        /**
+         * Open an archive to read from and load its index.
+         *
+         * @param filename the name of the archive.
+         * @return true if the archive is open, else false.
+         */
+        bool open(const string &filename);
+
+        /**
+         * Read the last record at or before a time.
+         *
+         * @param recordTime the UTC time, seconds since 1/1/70.
+         * @param header set to the record header.
+         * @param lines set to the text of the lines of the record.
+         * @return true if found, false if the time is before the
+         * archive or the block cannot be read.
+         */
+        bool read(time_t recordTime, StatusFeedHeader &header, vector<string> &lines);
+
+        /**
+         * Get the number of blocks in the archive being read.
+         *
+         * @return the number of blocks.
+         */
+        int getBlockCount() const;
+
+        /**
+         * Get the time of the first record in the archive being read.
+         *
+         * @return the time, 0 if the archive is empty.
+         */
+        time_t getFirstTime() const;
+
+        /**
+         * Get the time of the last record in the archive being read.
+         *
+         * @return the time, 0 if the archive is empty.
+         */
+        time_t getLastTime() const;
+
+        /**
+         * Write the last block and close the archive.
+         */
+        void close();
+
+    private:
+
+        /**
+         * Check if the lines of a record start with the same component
+         * names, in the same order, as those of the last record.
+         *
+         * @param lines the text of the lines of the record.
+         * @return true if they are the same.
+         */
+        bool sameComponents(const vector<string> &lines);
+
+        /**
+         * Read the block headers from an offset to the end of the archive
+         * and add them to the index.
+         *
+         * @param offset the offset of the first block header.
+         */
+        void scanBlocks(uint64_t offset);
+
+        /**
+         * Read and uncompress a block into m_block.
+         *
+         * @param index the index of the block in m_index.
+         * @return true if read, else false.
+         */
+        bool loadBlock(int index);
+
+        /** The archive, NULL if not open. */
+        FILE *m_fp;
+
+        /** The index being written, NULL if not open. */
+        FILE *m_indexFp;
+
+        /** True if open for writing. */
+        bool m_writing;
+
+        /** The records of the block being filled, uncompressed. */
+        string m_block;
+
+        /** The number of records in m_block. */
+        uint32_t m_blockRecords;
+
+        /** The time of the first record in m_block. */
+        int32_t m_blockFirstTime;
+
+        /** The wall clock time m_block was started. */
+        time_t m_blockStarted;
+
+        /** The header of the last record written. */
+        StatusFeedHeader m_lastHeader;
+
+        /** The lines of the last record written or read, the time marked. */
+        vector<string> m_last;
+
+        /** Whether each line of m_last has the time marked. */
+        vector<char> m_lastMarked;
+
+        /** A line of the record being written, the time marked. */
+        string m_marked;
+
+        /** The index of the archive being read. */
+        vector<StatusArchiveIndexEntry> m_index;
+
+        /** The index of the block in m_block when reading, -1 if none. */
+        int m_loadedBlock;
+
+        /** Reused for compressed data so blocks do not allocate. */
+        string m_compressed;
+};
+
+#endif //STATUSARCHIVE_H
@@ -0,0 +1,231 @@
+/*
+ * statusboard.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Shares the latest status record between processes.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file statusboard.cpp
+ * Shares the latest status record between processes.
+ */
+
+#include "statusboard.h"
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+/* Constructor. */
+StatusBoard::StatusBoard()
+{
+    m_data = NULL;
+    m_writable = false;
+    m_lockFd = -1;
+    m_lastSequence = 0;
+}
+
+/* Destructor. Unmaps the segment. */
+StatusBoard::~StatusBoard()
+{
+    detach();
+}
+
+/*
+ * Create the segment, or reuse an existing one, to publish to.
+ *
+ * @param name the shared memory name, e.g. STATUS_BOARD_NAME.
+ * @return true if the segment is mapped, else false, also if
+ * another publisher owns it.
+ */
+bool StatusBoard::create(const string &name)
+{
+    detach();
+
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0644);
+    if(fd < 0) return false;
+
+    //Only the truncate of a segment nobody else publishes to is safe.
+    if(flock(fd, LOCK_EX | LOCK_NB) != 0 ||
+            ftruncate(fd, sizeof(StatusBoardData)) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void *addr = mmap(NULL, sizeof(StatusBoardData), PROT_READ | PROT_WRITE,
+            MAP_SHARED, fd, 0);
+    if(addr == MAP_FAILED)
+    {
+        close(fd);
+        return false;
+    }
+
+    m_data = (StatusBoardData *)addr;
+    m_writable = true;
+    m_lockFd = fd;
+
+    //A viewer may still be attached to a segment left by an earlier
+    //publisher, so take the lock while setting it up.
+    uint32_t sequence = m_data->sequence | 1;
+    m_data->sequence = sequence;
+    __sync_synchronize();
+    memcpy(m_data->magic, STATUS_FEED_MAGIC, sizeof(m_data->magic));
+    m_data->version = STATUS_FEED_VERSION;
+    m_data->componentSize = sizeof(ComponentStatus);
+    __sync_synchronize();
+    m_data->sequence = sequence + 1;
+
+    return true;
+}
+
+/*
+ * Attach to a segment read only to view it.
+ *
+ * @param name the shared memory name, e.g. STATUS_BOARD_NAME.
+ * @return true if the segment is mapped and was created by a
+ * compatible publisher, else false.
+ */
+bool StatusBoard::attach(const string &name)
+{
+    detach();
+
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if(fd < 0) return false;
+
+    struct stat stbuf;
+    if(fstat(fd, &stbuf) != 0 || stbuf.st_size < (off_t)sizeof(StatusBoardData))
+    {
+        close(fd);
+        return false;
+    }
+
+    void *addr = mmap(NULL, sizeof(StatusBoardData), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(addr == MAP_FAILED) return false;
+
+    m_data = (StatusBoardData *)addr;
+    m_writable = false;
+    m_lastSequence = 0;
+
+    if(memcmp(m_data->magic, STATUS_FEED_MAGIC, sizeof(m_data->magic)) != 0 ||
+            m_data->version != STATUS_FEED_VERSION ||
+            m_data->componentSize != sizeof(ComponentStatus))
+    {
+        detach();
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Unmap the segment, and give it up if publishing. The segment
+ * itself is left for other viewers.
+ */
+void StatusBoard::detach()
+{
+    if(m_data != NULL) munmap(m_data, sizeof(StatusBoardData));
+    if(m_lockFd >= 0) close(m_lockFd);
+    m_data = NULL;
+    m_writable = false;
+    m_lockFd = -1;
+}
+
+/*
+ * Publish a record. Components past STATUS_BOARD_MAX_COMPONENTS
+ * are dropped.
+ *
+ * @param header the record header.
+ * @param record the components of the record.
+ * @return true if published, else false.
+ */
+bool StatusBoard::publish(const StatusFeedHeader &header,
+        const vector<ComponentStatus> &record)
+{
+    if(m_data == NULL || !m_writable) return false;
+
+    uint32_t count = (uint32_t)record.size();
+    if(count > STATUS_BOARD_MAX_COMPONENTS) count = STATUS_BOARD_MAX_COMPONENTS;
+
+    uint32_t sequence = m_data->sequence;
+    m_data->sequence = sequence + 1;
+    __sync_synchronize();
+
+    m_data->header = header;
+    m_data->header.count = count;
+    if(count > 0) memcpy(m_data->components, &record[0], count * sizeof(ComponentStatus));
+
+    __sync_synchronize();
+    m_data->sequence = sequence + 2;
+
+    return true;
+}
+
+/*
+ * Read the latest record if it is newer than the last one read.
+ *
+ * @param header set to the record header.
+ * @param record set to the components of the record.
+ * @return true if a new record was read, else false, also if
+ * the publisher stayed part way through a record for
+ * STATUS_BOARD_READ_TRIES tries.
+ */
+bool StatusBoard::read(StatusFeedHeader &header, vector<ComponentStatus> &record)
+{
+    if(m_data == NULL) return false;
+
+    for(int tries = 0; tries < STATUS_BOARD_READ_TRIES; tries++)
+    {
+        uint32_t before = m_data->sequence;
+        if(before == m_lastSequence) return false;
+        if(before & 1)
+        {
+            //The publisher is part way through a record.
+            sched_yield();
+            continue;
+        }
+        __sync_synchronize();
+
+        header = m_data->header;
+        uint32_t count = header.count;
+        if(count > STATUS_BOARD_MAX_COMPONENTS) count = STATUS_BOARD_MAX_COMPONENTS;
+        record.resize(count);
+        if(count > 0) memcpy(&record[0], m_data->components, count * sizeof(ComponentStatus));
+
+        __sync_synchronize();
+        if(m_data->sequence == before)
+        {
+            header.count = count;
+            m_lastSequence = before;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,159 @@
+/*
+ * statusboard.h
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Shares the latest status record between processes.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file statusboard.h
+ * Shares the latest status record between processes.
+ */
+
+#ifndef STATUSBOARD_H
+#define STATUSBOARD_H
+
+#include "statusfeed.h"
+
+using namespace std;
+
+/** The default POSIX shared memory name of the status board. */
+#define STATUS_BOARD_NAME "/sonataInfoDisplay"
+
+/** The most components the status board can hold. */
+#define STATUS_BOARD_MAX_COMPONENTS 1024
+
+/** The most times read() waits out a record being written before giving
+ * up until the next call, in case the publisher died part way. */
+#define STATUS_BOARD_READ_TRIES 200
+
+/**
+ * The layout of the status board shared memory segment.
+ */
+struct StatusBoardData
+{
+    /** STATUS_FEED_MAGIC. */
+    char magic[4];
+    /** STATUS_FEED_VERSION. */
+    uint16_t version;
+    /** sizeof(ComponentStatus) of the publisher. */
+    uint16_t componentSize;
+    /** Odd while the publisher is writing, incremented twice per record. */
+    volatile uint32_t sequence;
+    /** The header of the latest record. */
+    StatusFeedHeader header;
+    /** The components of the latest record, header.count of them. */
+    ComponentStatus components[STATUS_BOARD_MAX_COMPONENTS];
+};
+
+/**
+ * Shares the latest status record between processes through a POSIX
+ * shared memory segment, so that one publisher can parse
+ * "sse-system-status.txt" for any number of viewers.
+ *
+ * The record is guarded by a sequence lock. The publisher makes the
+ * sequence odd, copies the record in and makes it even again. A viewer
+ * reads the sequence, copies the record out and reads the sequence
+ * again, retrying if it was odd or has changed. Viewers map the segment
+ * read only, never block the publisher, and checking for a new record
+ * costs no system calls.
+ *
+ * Only one publisher may own a segment. It holds an exclusive flock()
+ * on the segment for as long as it is attached, which the system drops
+ * if it dies, so a second publisher is refused rather than breaking
+ * the sequence lock.
+ */
+class StatusBoard
+{
+    public:
+
+        /** Constructor. */
+        StatusBoard();
+
+        /** Destructor. Unmaps the segment. */
+        ~StatusBoard();
+
+        /**
+         * Create the segment, or reuse an existing one, to publish to.
+         *
+         * @param name the shared memory name, e.g. STATUS_BOARD_NAME.
+         * @return true if the segment is mapped, else false, also if
+         * another publisher owns it.
+         */
+        bool create(const string &name);
+
+        /**
+         * Attach to a segment read only to view it.
+         *
+         * @param name the shared memory name, e.g. STATUS_BOARD_NAME.
+         * @return true if the segment is mapped and was created by a
+         * compatible publisher, else false.
+         */
+        bool attach(const string &name);
+
+        /**
+         * Unmap the segment, and give it up if publishing. The segment
+         * itself is left for other viewers.
+         */
+        void detach();
+
+        /**
+         * Publish a record. Components past STATUS_BOARD_MAX_COMPONENTS
+         * are dropped.
+         *
+         * @param header the record header.
+         * @param record the components of the record.
+         * @return true if published, else false.
+         */
+        bool publish(const StatusFeedHeader &header, const vector<ComponentStatus> &record);
+
+        /**
+         * Read the latest record if it is newer than the last one read.
+         *
+         * @param header set to the record header.
+         * @param record set to the components of the record.
+         * @return true if a new record was read, else false, also if
+         * the publisher stayed part way through a record for
+         * STATUS_BOARD_READ_TRIES tries.
+         */
+        bool read(StatusFeedHeader &header, vector<ComponentStatus> &record);
+
+    private:
+
+        /** The mapped segment, NULL if none. */
+        StatusBoardData *m_data;
+
+        /** True if mapped for publishing. */
+        bool m_writable;
+
+        /** The segment, held open and locked while publishing, else -1. */
+        int m_lockFd;
+
+        /** The sequence of the last record read. */
+        uint32_t m_lastSequence;
+};
+
+#endif //STATUSBOARD_H
+
@@ -0,0 +1,289 @@
+/*
+ * statusdelta.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Writes the changes between status records.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file statusdelta.cpp
+ * Writes the changes between status records.
+ */
+
+#include "statusdelta.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/*
+ * Constructor. Writes to stdout.
+ *
+ * @param format the output format.
+ */
+StatusDelta::StatusDelta(format_t format)
+{
+    m_format = format;
+    m_listenFd = -1;
+}
+
+/* Destructor. Closes the socket and clients. */
+StatusDelta::~StatusDelta()
+{
+    for(int i = 0; i < (int)m_clients.size(); i++) close(m_clients[i]);
+    if(m_listenFd >= 0)
+    {
+        close(m_listenFd);
+        unlink(m_path.c_str());
+    }
+}
+
+/*
+ * Write to clients of a UNIX socket instead of stdout.
+ *
+ * @param path the socket path. Any existing file is replaced.
+ * @return true if listening, else false.
+ */
+bool StatusDelta::listen(const string &path)
+{
+    struct sockaddr_un addr;
+
+    if(path.size() >= sizeof(addr.sun_path)) return false;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0) return false;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path.c_str());
+    unlink(path.c_str());
+
+    if(bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+            ::listen(fd, 8) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    m_listenFd = fd;
+    m_path = path;
+    return true;
+}
+
+/*
+ * Write the changes from the last record.
+ *
+ * @param header the record header.
+ * @param record the components of the record.
+ * @return the number of components written.
+ */
+int StatusDelta::write(const StatusFeedHeader &header,
+        const vector<ComponentStatus> &record)
+{
+    m_changed.clear();
+
+    //Components that are new or have changed.
+    for(int i = 0; i < (int)record.size(); i++)
+    {
+        map<string, ComponentStatus>::iterator it = m_last.find(record[i].name);
+        if(it == m_last.end())
+        {
+            m_last[record[i].name] = record[i];
+            m_changed.push_back(record[i]);
+        }
+        else if(changed(it->second, record[i]))
+        {
+            it->second = record[i];
+            m_changed.push_back(record[i]);
+        }
+        else
+        {
+            it->second.timestamp = record[i].timestamp;
+        }
+    }
+
+    //Components that have gone. A record rarely has any, so the names
+    //are only collected when the counts disagree.
+    if(m_last.size() > record.size())
+    {
+        map<string, bool> present;
+        for(int i = 0; i < (int)record.size(); i++) present[record[i].name] = true;
+
+        map<string, ComponentStatus>::iterator it = m_last.begin();
+        while(it != m_last.end())
+        {
+            if(present.find(it->first) == present.end())
+            {
+                ComponentStatus gone = it->second;
+                gone.state = ComponentStatus::state_unknown;
+                gone.timestamp = header.timestamp;
+                m_changed.push_back(gone);
+                m_last.erase(it++);
+            }
+            else it++;
+        }
+    }
+
+    m_header = header;
+    poll();
+
+    if(m_changed.empty()) return 0;
+
+    m_buffer.clear();
+    encode(header, m_changed, m_buffer);
+
+    if(m_listenFd < 0)
+    {
+        fwrite(m_buffer.data(), 1, m_buffer.size(), stdout);
+        fflush(stdout);
+    }
+    else
+    {
+        for(int i = (int)m_clients.size() - 1; i >= 0; i--) sendTo(i, m_buffer);
+    }
+
+    return (int)m_changed.size();
+}
+
+/*
+ * Format a component as a JSON object on one line.
+ *
+ * @param timestamp the record time, seconds since 1/1/70.
+ * @param status the component.
+ * @param buffer the buffer to append the line to.
+ */
+void StatusDelta::formatJson(time_t timestamp, const ComponentStatus &status,
+        string &buffer)
+{
+    char line[256];
+
+    //Names are taken from the status file, so keep only the characters
+    //that need no escaping.
+    char name[ComponentStatus::MAX_NAME];
+    int len = 0;
+    for(int i = 0; i < ComponentStatus::MAX_NAME - 1 && status.name[i] != 0; i++)
+    {
+        char c = status.name[i];
+        if(c >= ' ' && c != '"' && c != '\\') name[len++] = c;
+    }
+    name[len] = 0;
+
+    snprintf(line, sizeof(line),
+            "{\"time\":%ld,\"name\":\"%s\",\"kind\":\"%s\",\"state\":\"%s\","
+            "\"activity\":%d,\"skyMHz\":%.3f,\"channel\":%d}\n",
+            (long)timestamp, name, ComponentStatus::kindName(status.kind),
+            ComponentStatus::stateName(status.state), (int)status.activityId,
+            status.skyFreqMHz, (int)status.channel);
+    buffer += line;
+}
+
+/*
+ * Encode components in the output format.
+ *
+ * @param header the record header.
+ * @param components the components to encode.
+ * @param buffer the buffer to append to.
+ */
+void StatusDelta::encode(const StatusFeedHeader &header,
+        const vector<ComponentStatus> &components, string &buffer)
+{
+    if(m_format == format_binary)
+    {
+        StatusFeed::encode(header, components, buffer);
+        return;
+    }
+
+    for(int i = 0; i < (int)components.size(); i++)
+        formatJson(header.timestamp, components[i], buffer);
+}
+
+/*
+ * Accept clients waiting on the socket and send each the full
+ * state. Called by write(), and should be called while idle so
+ * that clients do not wait for the next change.
+ */
+void StatusDelta::poll()
+{
+    int fd;
+
+    if(m_listenFd < 0) return;
+
+    while((fd = accept(m_listenFd, NULL, NULL)) >= 0)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        m_clients.push_back(fd);
+
+        vector<ComponentStatus> all;
+        map<string, ComponentStatus>::iterator it;
+        for(it = m_last.begin(); it != m_last.end(); it++) all.push_back(it->second);
+
+        string buffer;
+        encode(m_header, all, buffer);
+        sendTo((int)m_clients.size() - 1, buffer);
+    }
+}
+
+/*
+ * Send a buffer to a client, disconnecting it on error.
+ *
+ * @param index the index of the client in m_clients.
+ * @param buffer the data.
+ * @return true if sent, else false and the client is removed.
+ */
+bool StatusDelta::sendTo(int index, const string &buffer)
+{
+    size_t sent = 0;
+
+    while(sent < buffer.size())
+    {
+        ssize_t count = send(m_clients[index], buffer.data() + sent,
+                buffer.size() - sent, MSG_NOSIGNAL);
+        if(count < 0 && errno == EINTR) continue;
+        if(count <= 0)
+        {
+            //Gone, or too far behind to catch up.
+            close(m_clients[index]);
+            m_clients.erase(m_clients.begin() + index);
+            return false;
+        }
+        sent += count;
+    }
+
+    return true;
+}
+
+/*
+ * Check if a component has changed.
+ */
+bool StatusDelta::changed(const ComponentStatus &a, const ComponentStatus &b)
+{
+    return a.kind != b.kind || a.state != b.state ||
+        a.activityId != b.activityId || a.skyFreqMHz != b.skyFreqMHz ||
+        a.channel != b.channel;
+}
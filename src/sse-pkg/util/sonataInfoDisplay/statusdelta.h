@@ -0,0 +1,165 @@
+/*
+ * statusdelta.h
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Writes the changes between status records.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file statusdelta.h
+ * Writes the changes between status records.
+ */
+
+#ifndef STATUSDELTA_H
+#define STATUSDELTA_H
+
+#include "statusfeed.h"
+#include <map>
+
+using namespace std;
+
+/**
+ * Writes only the components that changed from one status record to
+ * the next, for the headless mode of sonataInfoDisplay.
+ *
+ * A component has changed if its kind, state, activity, sky frequency
+ * or channel differ from the last record; the time on its status line
+ * alone does not count. A component missing from a record is written
+ * once with the state "Unknown".
+ *
+ * The changes go to stdout, or to every client connected to a local
+ * UNIX socket. A new client is first sent every component, so it starts
+ * from the full state. A client that cannot keep up is disconnected
+ * rather than buffered for.
+ */
+class StatusDelta
+{
+    public:
+
+        /**
+         * The output formats.
+         */
+        enum format_t
+        {
+            /** One JSON object per changed component per line. */
+            format_json,
+            /** A StatusFeed record holding only the changed components. */
+            format_binary
+        };
+
+        /**
+         * Constructor. Writes to stdout.
+         *
+         * @param format the output format.
+         */
+        StatusDelta(format_t format);
+
+        /** Destructor. Closes the socket and clients. */
+        ~StatusDelta();
+
+        /**
+         * Write to clients of a UNIX socket instead of stdout.
+         *
+         * @param path the socket path. Any existing file is replaced.
+         * @return true if listening, else false.
+         */
+        bool listen(const string &path);
+
+        /**
+         * Write the changes from the last record.
+         *
+         * @param header the record header.
+         * @param record the components of the record.
+         * @return the number of components written.
+         */
+        int write(const StatusFeedHeader &header, const vector<ComponentStatus> &record);
+
+        /**
+         * Accept clients waiting on the socket and send each the full
+         * state. Called by write(), and should be called while idle so
+         * that clients do not wait for the next change.
+         */
+        void poll();
+
+        /**
+         * Format a component as a JSON object on one line.
+         *
+         * @param timestamp the record time, seconds since 1/1/70.
+         * @param status the component.
+         * @param buffer the buffer to append the line to.
+         */
+        static void formatJson(time_t timestamp, const ComponentStatus &status,
+                string &buffer);
+
+    private:
+
+        /**
+         * Encode components in the output format.
+         *
+         * @param header the record header.
+         * @param components the components to encode.
+         * @param buffer the buffer to append to.
+         */
+        void encode(const StatusFeedHeader &header,
+                const vector<ComponentStatus> &components, string &buffer);
+
+        /**
+         * Send a buffer to a client, disconnecting it on error.
+         *
+         * @param index the index of the client in m_clients.
+         * @param buffer the data.
+         * @return true if sent, else false and the client is removed.
+         */
+        bool sendTo(int index, const string &buffer);
+
+        /**
+         * Check if a component has changed.
+         */
+        static bool changed(const ComponentStatus &a, const ComponentStatus &b);
+
+        format_t m_format;
+
+        /** The socket listened on, -1 to write to stdout. */
+        int m_listenFd;
+
+        /** The path of the socket. */
+        string m_path;
+
+        /** The connected clients. */
+        vector<int> m_clients;
+
+        /** The header of the last record. */
+        StatusFeedHeader m_header;
+
+        /** The components of the last record, by name. */
+        map<string, ComponentStatus> m_last;
+
+        /** Reused for each record so writing does not allocate. */
+        vector<ComponentStatus> m_changed;
+        string m_buffer;
+};
+
+#endif //STATUSDELTA_H
+
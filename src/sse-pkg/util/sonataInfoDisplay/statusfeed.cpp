@@ -0,0 +1,170 @@
+/*
+ * statusfeed.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Reads and writes the binary status feed.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file statusfeed.cpp
+ * Reads and writes the binary status feed.
+ */
+
+#include "statusfeed.h"
+#include <string.h>
+
+/*
+ * Constructor. Initializes an empty record.
+ */
+StatusFeedHeader::StatusFeedHeader()
+{
+    memcpy(magic, STATUS_FEED_MAGIC, sizeof(magic));
+    version = STATUS_FEED_VERSION;
+    componentSize = sizeof(ComponentStatus);
+    count = 0;
+    timestamp = 0;
+    activityId = -1;
+    minDxFreqMHz = 0.0;
+    maxDxFreqMHz = 0.0;
+}
+
+/* Constructor. */
+StatusFeed::StatusFeed()
+{
+    m_fp = NULL;
+}
+
+/* Destructor. Closes the file if it is open. */
+StatusFeed::~StatusFeed()
+{
+    close();
+}
+
+/*
+ * Open a file to write records to. Records are appended.
+ *
+ * @param filename the name of the file.
+ * @return true if the file is open, else false.
+ */
+bool StatusFeed::open(const string &filename)
+{
+    close();
+    m_fp = fopen(filename.c_str(), "ab");
+    return (m_fp != NULL);
+}
+
+/*
+ * Append a record to the open file.
+ *
+ * @param header the record header. The magic, version, size
+ * and count are filled in.
+ * @param record the components of the record.
+ * @return true if written, else false.
+ */
+bool StatusFeed::write(const StatusFeedHeader &header,
+        const vector<ComponentStatus> &record)
+{
+    if(m_fp == NULL) return false;
+
+    m_buffer.clear();
+    encode(header, record, m_buffer);
+
+    //Write the whole record at once so a reader tailing the file
+    //rarely sees half of one.
+    if(fwrite(m_buffer.data(), 1, m_buffer.size(), m_fp) != m_buffer.size())
+        return false;
+    fflush(m_fp);
+
+    return true;
+}
+
+/*
+ * Close the file.
+ */
+void StatusFeed::close()
+{
+    if(m_fp != NULL) fclose(m_fp);
+    m_fp = NULL;
+}
+
+/*
+ * Encode a record and append it to a buffer.
+ *
+ * @param header the record header. The magic, version, size
+ * and count are filled in.
+ * @param record the components of the record.
+ * @param buffer the buffer to append to.
+ */
+void StatusFeed::encode(const StatusFeedHeader &header,
+        const vector<ComponentStatus> &record, string &buffer)
+{
+    StatusFeedHeader out = header;
+    memcpy(out.magic, STATUS_FEED_MAGIC, sizeof(out.magic));
+    out.version = STATUS_FEED_VERSION;
+    out.componentSize = sizeof(ComponentStatus);
+    out.count = (uint32_t)record.size();
+
+    buffer.append((const char *)&out, sizeof(out));
+    if(!record.empty())
+        buffer.append((const char *)&record[0],
+                record.size() * sizeof(ComponentStatus));
+}
+
+/*
+ * Decode a record from the start of a buffer.
+ *
+ * @param buffer the start of the buffer.
+ * @param length the number of bytes in the buffer.
+ * @param header set to the record header.
+ * @param record set to the components of the record.
+ * @return the number of bytes used, 0 if the buffer does not yet
+ * hold a whole record, -1 if the buffer does not start with a
+ * record this version can read: a bad magic, a newer version, a
+ * different sizeof(ComponentStatus) or more than
+ * STATUS_FEED_MAX_COMPONENTS components.
+ */
+int StatusFeed::decode(const char *buffer, int length,
+        StatusFeedHeader &header, vector<ComponentStatus> &record)
+{
+    if(length < (int)sizeof(StatusFeedHeader)) return 0;
+
+    StatusFeedHeader in;
+    memcpy(&in, buffer, sizeof(in));
+    if(memcmp(in.magic, STATUS_FEED_MAGIC, sizeof(in.magic)) != 0 ||
+            in.version < 1 || in.version > STATUS_FEED_VERSION ||
+            in.componentSize != sizeof(ComponentStatus) ||
+            in.count > STATUS_FEED_MAX_COMPONENTS)
+        return -1;
+
+    long total = (long)sizeof(in) + (long)in.count * in.componentSize;
+    if(total > length) return 0;
+
+    header = in;
+    record.resize(in.count);
+    if(in.count > 0)
+        memcpy(&record[0], buffer + sizeof(in), in.count * sizeof(ComponentStatus));
+
+    return (int)total;
+}
@@ -0,0 +1,161 @@
+/*
+ * statusfeed.h
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Reads and writes the binary status feed.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file statusfeed.h
+ * Reads and writes the binary status feed.
+ */
+
+#ifndef STATUSFEED_H
+#define STATUSFEED_H
+
+#include "componentstatus.h"
+#include <stdio.h>
+#include <vector>
+
+using namespace std;
+
+/** The first 4 bytes of every record in the binary status feed. */
+#define STATUS_FEED_MAGIC "SSR\n"
+
+/** The version of the binary status feed format. */
+#define STATUS_FEED_VERSION 1
+
+/** The most components decode() accepts in a record, far more than any
+ * site has. A larger count is taken as a corrupt header. */
+#define STATUS_FEED_MAX_COMPONENTS 65535
+
+/**
+ * The header of one record in the binary status feed. It is followed
+ * by count ComponentStatus structures of componentSize bytes each.
+ * Both are written in host byte order.
+ */
+struct StatusFeedHeader
+{
+    /** STATUS_FEED_MAGIC. */
+    char magic[4];
+    /** STATUS_FEED_VERSION. */
+    uint16_t version;
+    /** sizeof(ComponentStatus) of the writer. */
+    uint16_t componentSize;
+    /** The number of components that follow. */
+    uint32_t count;
+    /** The UTC time of the record, seconds since 1/1/70. */
+    int32_t timestamp;
+    /** The current activity id, -1 if none. */
+    int32_t activityId;
+    /** The lowest sky frequency of the dxs with a channel, MHz. */
+    float minDxFreqMHz;
+    /** The highest sky frequency of the dxs with a channel, MHz. */
+    float maxDxFreqMHz;
+
+    /** Constructor. Initializes an empty record. */
+    StatusFeedHeader();
+};
+
+/**
+ * Reads and writes the binary status feed, a compact alternative to
+ * "sse-system-status.txt".
+ *
+ * Each record is a StatusFeedHeader followed by one fixed size
+ * ComponentStatus per component, so a reader loads a record with no
+ * parsing at all. encode() and decode() work on memory buffers so the
+ * same format can be used for files, sockets and shared memory.
+ */
+class StatusFeed
+{
+    public:
+
+        /** Constructor. */
+        StatusFeed();
+
+        /** Destructor. Closes the file if it is open. */
+        ~StatusFeed();
+
+        /**
+         * Open a file to write records to. Records are appended.
+         *
+         * @param filename the name of the file.
+         * @return true if the file is open, else false.
+         */
+        bool open(const string &filename);
+
+        /**
+         * Append a record to the open file.
+         *
+         * @param header the record header. The magic, version, size
+         * and count are filled in.
+         * @param record the components of the record.
+         * @return true if written, else false.
+         */
+        bool write(const StatusFeedHeader &header, const vector<ComponentStatus> &record);
+
+        /**
+         * Close the file.
+         */
+        void close();
+
+        /**
+         * Encode a record and append it to a buffer.
+         *
+         * @param header the record header. The magic, version, size
+         * and count are filled in.
+         * @param record the components of the record.
+         * @param buffer the buffer to append to.
+         */
+        static void encode(const StatusFeedHeader &header,
+                const vector<ComponentStatus> &record, string &buffer);
+
+        /**
+         * Decode a record from the start of a buffer.
+         *
+         * @param buffer the start of the buffer.
+         * @param length the number of bytes in the buffer.
+         * @param header set to the record header.
+         * @param record set to the components of the record.
+         * @return the number of bytes used, 0 if the buffer does not yet
+         * hold a whole record, -1 if the buffer does not start with a
+         * record this version can read: a bad magic, a newer version, a
+         * different sizeof(ComponentStatus) or more than
+         * STATUS_FEED_MAX_COMPONENTS components.
+         */
+        static int decode(const char *buffer, int length,
+                StatusFeedHeader &header, vector<ComponentStatus> &record);
+
+    private:
+
+        /** The file being written, NULL if none. */
+        FILE *m_fp;
+
+        /** Reused for encoding so writing does not allocate. */
+        string m_buffer;
+};
+
+#endif //STATUSFEED_H
+
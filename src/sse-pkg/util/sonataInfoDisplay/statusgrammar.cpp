@@ -0,0 +1,424 @@
+/*
+ * statusgrammar.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * The grammar of the lines in "sse-system-status.txt".
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file statusgrammar.cpp
+ * The grammar of the lines in "sse-system-status.txt".
+ */
+
+#include "statusgrammar.h"
+#include "utils.h"
+#include <string.h>
+
+/**
+ * The grammar. For each kind of component, the forms of its lines, the
+ * usual one first:
+ *
+ * dx1001 (beam1) 2010-08-07 00:19:34 UTC  Act 2735: Init  Sky: 8424.914 MHz Chan: 13
+ * dx1003 (beam1) 2010-08-07 00:19:34 UTC  Offline
+ * chan1x  2010-08-07 00:19:34 UTC Run
+ * tscope  ATA connected
+ * NSS  2010-08-07 00:19:34 UTC  Status
+ */
+static const struct
+{
+    int kind;
+    const char *rule;
+} GRAMMAR[] = {
+    { ComponentStatus::kind_dx,
+        "%name %beam? %date %time UTC Act %activity: %state Sky: %sky MHz Chan: %channel" },
+    { ComponentStatus::kind_dx, "%name %beam? %date %time UTC Act %activity: %state" },
+    { ComponentStatus::kind_dx, "%name %beam? %date %time UTC %state" },
+    { ComponentStatus::kind_chan, "%name %date %time UTC %state" },
+    { ComponentStatus::kind_arch, "%name %date %time UTC %state" },
+    { ComponentStatus::kind_tscope, "%name %date %time UTC %state" },
+    { ComponentStatus::kind_tscope, "%name %state" },
+    { ComponentStatus::kind_beam, "%name %date %time UTC %state" },
+    { ComponentStatus::kind_beam, "%name %state" },
+    { ComponentStatus::kind_array, "%name %date %time UTC %state" },
+    { ComponentStatus::kind_array, "%name %state" },
+    { ComponentStatus::kind_primary, "%name %date %time UTC %state" },
+    { ComponentStatus::kind_primary, "%name %state" },
+    { ComponentStatus::kind_unknown, "NSS %date %time UTC %state" }
+};
+
+/**
+ * The state phrases. Each kind_unknown entry applies to every kind.
+ */
+static const struct
+{
+    int kind;
+    const char *phrase;
+    ComponentStatus::component_state_t state;
+} STATE_PHRASES[] = {
+    { ComponentStatus::kind_unknown, "Offline", ComponentStatus::state_offline },
+    { ComponentStatus::kind_dx, "No Activities", ComponentStatus::state_idle },
+    { ComponentStatus::kind_dx, "Init", ComponentStatus::state_init },
+    { ComponentStatus::kind_dx, "Tuned", ComponentStatus::state_tuned },
+    { ComponentStatus::kind_dx, "Pend Base Accum", ComponentStatus::state_pend_base_accum },
+    { ComponentStatus::kind_dx, "Base Accum", ComponentStatus::state_base_accum },
+    { ComponentStatus::kind_dx, "Base Accum Complete", ComponentStatus::state_base_accum_complete },
+    { ComponentStatus::kind_dx, "Pend Data Coll", ComponentStatus::state_pend_data_coll },
+    { ComponentStatus::kind_dx, "Data Coll", ComponentStatus::state_data_coll },
+    { ComponentStatus::kind_dx, "Data Coll Complete", ComponentStatus::state_data_coll_complete },
+    { ComponentStatus::kind_dx, "Pend Sig Det", ComponentStatus::state_pend_sig_det },
+    { ComponentStatus::kind_dx, "Sig Det", ComponentStatus::state_sig_det },
+    { ComponentStatus::kind_dx, "Sig Det Complete", ComponentStatus::state_sig_det_complete },
+    { ComponentStatus::kind_dx, "Complete", ComponentStatus::state_complete },
+    { ComponentStatus::kind_dx, "Stopping", ComponentStatus::state_stopping },
+    { ComponentStatus::kind_dx, "Stopped", ComponentStatus::state_stopped },
+    { ComponentStatus::kind_dx, "Error", ComponentStatus::state_error },
+    { ComponentStatus::kind_chan, "Run", ComponentStatus::state_running },
+    { ComponentStatus::kind_unknown, "Running", ComponentStatus::state_running }
+};
+
+/*
+ * Constructor. Initializes no fields.
+ */
+StatusLine::StatusLine()
+{
+    rule = -1;
+    timestamp = 0;
+    date = NULL;
+    time = NULL;
+    utcOffset = string::npos;
+    activityId = -1;
+    skyFreqMHz = 0.0;
+    channel = -1;
+    state = "";
+    stateLength = 0;
+}
+
+/* Constructor. */
+StatusGrammar::StatusGrammar()
+{
+    memset(m_lastDateTime, 0, sizeof(m_lastDateTime));
+    m_lastTimestamp = 0;
+}
+
+/*
+ * Read a fixed number of digits.
+ */
+static bool readDigits(const char *text, int count, int &value)
+{
+    value = 0;
+    for(int i = 0; i < count; i++)
+    {
+        if(text[i] < '0' || text[i] > '9') return false;
+        value = value * 10 + (text[i] - '0');
+    }
+    return true;
+}
+
+/*
+ * Check for a character that separates words. The line ending is one,
+ * as the lines come from fgets() with it.
+ */
+static bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/*
+ * Step to the next word of a line, so the line is read only once.
+ *
+ * @param word set to the start of the next word, end if none.
+ * @param wordEnd the end of the current word, set to the end of the
+ * next one.
+ * @param end the end of the line.
+ */
+static void nextWord(const char *&word, const char *&wordEnd, const char *end)
+{
+    word = wordEnd;
+    while(word < end && isBlank(*word)) word++;
+    wordEnd = word;
+    while(wordEnd < end && !isBlank(*wordEnd)) wordEnd++;
+}
+
+/*
+ * Compile the rule table.
+ */
+const vector<StatusGrammar::Rule> &StatusGrammar::getRules()
+{
+    static vector<Rule> rules;
+    if(!rules.empty()) return rules;
+
+    static const struct
+    {
+        const char *name;
+        element_t type;
+    } fields[] = {
+        { "name", element_name },
+        { "beam", element_beam },
+        { "date", element_date },
+        { "time", element_time },
+        { "activity", element_activity },
+        { "sky", element_sky },
+        { "channel", element_channel },
+        { "state", element_state }
+    };
+
+    for(int i = 0; i < (int)(sizeof(GRAMMAR)/sizeof(GRAMMAR[0])); i++)
+    {
+        Rule rule;
+        rule.kind = GRAMMAR[i].kind;
+
+        const char *word = GRAMMAR[i].rule;
+        while(*word != 0)
+        {
+            size_t length = strcspn(word, " ");
+            Element element;
+            element.type = element_literal;
+            element.literal.assign(word, length);
+            element.suffix = 0;
+            element.optional = false;
+
+            if(length > 1 && word[0] == '%')
+            {
+                string name(word + 1, length - 1);
+                if(name[name.size() - 1] == '?')
+                {
+                    element.optional = true;
+                    name.erase(name.size() - 1);
+                }
+                if(name[name.size() - 1] == ':')
+                {
+                    element.suffix = ':';
+                    name.erase(name.size() - 1);
+                }
+                for(int f = 0; f < (int)(sizeof(fields)/sizeof(fields[0])); f++)
+                    if(name == fields[f].name) element.type = fields[f].type;
+                element.literal = "";
+            }
+            rule.elements.push_back(element);
+
+            word += length;
+            while(*word == ' ') word++;
+        }
+        rules.push_back(rule);
+    }
+
+    return rules;
+}
+
+/*
+ * Match a line against the rules for its kind of component.
+ *
+ * @param kind the ComponentStatus::component_kind_t of the line,
+ * kind_unknown for the "NSS" record header.
+ * @param line the start of the line.
+ * @param length the length of the line.
+ * @param fields set to the fields of the line.
+ * @return true if a rule matched the whole line, else false.
+ */
+bool StatusGrammar::match(int kind, const char *line, size_t length, StatusLine &fields)
+{
+    const vector<Rule> &rules = getRules();
+
+    //The line ending is not part of the last field.
+    while(length > 0 && isBlank(line[length - 1])) length--;
+
+    for(int i = 0; i < (int)rules.size(); i++)
+    {
+        if(rules[i].kind != kind) continue;
+
+        fields = StatusLine();
+        if(matchRule(rules[i], line, line + length, fields))
+        {
+            fields.rule = i;
+            return true;
+        }
+    }
+
+    fields = StatusLine();
+    return false;
+}
+
+/*
+ * Match a line against one rule.
+ */
+bool StatusGrammar::matchRule(const Rule &rule, const char *line, const char *end,
+        StatusLine &fields)
+{
+    const char *word = line;
+    const char *wordEnd = line;
+    int count = (int)rule.elements.size();
+
+    nextWord(word, wordEnd, end);
+    for(int i = 0; i < count; i++)
+    {
+        const Element &element = rule.elements[i];
+
+        if(element.type == element_state)
+        {
+            //Up to the next literal word, or the end of the line.
+            const Element *stop = (i + 1 < count) ? &rule.elements[i + 1] : NULL;
+            fields.state = word;
+            fields.stateLength = 0;
+            while(word < end)
+            {
+                if(stop != NULL && stop->literal.size() == (size_t)(wordEnd - word) &&
+                        memcmp(stop->literal.data(), word, wordEnd - word) == 0)
+                    break;
+                fields.stateLength = wordEnd - fields.state;
+                nextWord(word, wordEnd, end);
+            }
+            if(stop != NULL && word >= end) return false;
+            continue;
+        }
+
+        if(word < end && matchWord(element, word, wordEnd, fields))
+        {
+            if(element.type == element_literal && element.literal == "UTC")
+                fields.utcOffset = word - line;
+            nextWord(word, wordEnd, end);
+        }
+        else if(!element.optional) return false;
+    }
+
+    //The whole line must be used.
+    if(word < end) return false;
+
+    if(fields.date != NULL && fields.time != NULL)
+    {
+        //Every line of a record has the same time, convert it once.
+        if(memcmp(m_lastDateTime, fields.date, 10) == 0 &&
+                memcmp(m_lastDateTime + 10, fields.time, 8) == 0)
+        {
+            fields.timestamp = m_lastTimestamp;
+            return true;
+        }
+
+        struct tm t;
+        memset(&t, 0, sizeof(t));
+        if(!readDigits(fields.date, 4, t.tm_year) ||
+                !readDigits(fields.date + 5, 2, t.tm_mon) ||
+                !readDigits(fields.date + 8, 2, t.tm_mday) ||
+                !readDigits(fields.time, 2, t.tm_hour) ||
+                !readDigits(fields.time + 3, 2, t.tm_min) ||
+                !readDigits(fields.time + 6, 2, t.tm_sec))
+            return false;
+
+        t.tm_year -= 1900;
+        t.tm_mon -= 1;
+        fields.timestamp = timegm(&t);
+
+        memcpy(m_lastDateTime, fields.date, 10);
+        memcpy(m_lastDateTime + 10, fields.time, 8);
+        m_lastTimestamp = fields.timestamp;
+    }
+
+    return true;
+}
+
+/*
+ * Match one word against one element that is not element_state.
+ */
+bool StatusGrammar::matchWord(const Element &element, const char *word,
+        const char *wordEnd, StatusLine &fields)
+{
+    size_t length = wordEnd - word;
+
+    //A literal that must follow the value.
+    if(element.suffix != 0)
+    {
+        if(length < 2 || wordEnd[-1] != element.suffix) return false;
+        wordEnd--;
+        length--;
+    }
+
+    long number;
+    double real;
+    const char *next = NULL;
+
+    switch(element.type)
+    {
+        case element_literal:
+            return (element.literal.size() == length &&
+                    memcmp(element.literal.data(), word, length) == 0);
+
+        case element_name:
+            return true;
+
+        case element_beam:
+            return (length > 2 && word[0] == '(' && wordEnd[-1] == ')');
+
+        case element_date:
+            if(length != 10 || word[4] != '-' || word[7] != '-') return false;
+            fields.date = word;
+            return true;
+
+        case element_time:
+            if(length != 8 || word[2] != ':' || word[5] != ':') return false;
+            fields.time = word;
+            return true;
+
+        case element_activity:
+        case element_channel:
+            if(!Utils::parseInt(word, wordEnd, number, &next) || next != wordEnd)
+                return false;
+            if(element.type == element_activity) fields.activityId = (int32_t)number;
+            else fields.channel = (int32_t)number;
+            return true;
+
+        case element_sky:
+            if(!Utils::parseFloat(word, wordEnd, real, &next) || next != wordEnd)
+                return false;
+            fields.skyFreqMHz = (float)real;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/*
+ * Get the state named by the state text of a line.
+ *
+ * @param kind the ComponentStatus::component_kind_t of the line.
+ * @param text the state text.
+ * @param length the length of the state text.
+ * @return the ComponentStatus::component_state_t value,
+ * state_last if the phrase is not known.
+ */
+int StatusGrammar::parseState(int kind, const char *text, size_t length)
+{
+    for(int i = 0; i < (int)(sizeof(STATE_PHRASES)/sizeof(STATE_PHRASES[0])); i++)
+    {
+        if(STATE_PHRASES[i].kind != kind &&
+                STATE_PHRASES[i].kind != ComponentStatus::kind_unknown)
+            continue;
+
+        if(strlen(STATE_PHRASES[i].phrase) == length &&
+                memcmp(STATE_PHRASES[i].phrase, text, length) == 0)
+            return STATE_PHRASES[i].state;
+    }
+
+    return ComponentStatus::state_last;
+}
@@ -0,0 +1,197 @@
+/*
+ * statusgrammar.h
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * The grammar of the lines in "sse-system-status.txt".
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file statusgrammar.h
+ * The grammar of the lines in "sse-system-status.txt".
+ */
+
+#ifndef STATUSGRAMMAR_H
+#define STATUSGRAMMAR_H
+
+#include "componentstatus.h"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * The fields of one status line, as found by StatusGrammar::match().
+ * The text fields point into the line.
+ */
+struct StatusLine
+{
+    /** The rule that matched, an index into the grammar. */
+    int rule;
+    /** The UTC time on the line, 0 if it has none. */
+    time_t timestamp;
+    /** The date on the line, "YYYY-MM-DD", NULL if none. */
+    const char *date;
+    /** The time on the line, "HH:MM:SS", NULL if none. */
+    const char *time;
+    /** The offset of "UTC" in the line, string::npos if none. */
+    size_t utcOffset;
+    /** The activity id, -1 if none. */
+    int32_t activityId;
+    /** The sky frequency in MHz, 0 if none. */
+    float skyFreqMHz;
+    /** The channel, -1 if none. */
+    int32_t channel;
+    /** The state text, such as "Data Coll Complete". */
+    const char *state;
+    /** The length of the state text. */
+    size_t stateLength;
+
+    /** Constructor. Initializes no fields. */
+    StatusLine();
+};
+
+/**
+ * The grammar of the lines in "sse-system-status.txt" and a matcher
+ * that reads the fields of a line in one pass over its words.
+ *
+ * Each kind of line is described by a rule, one line in the table in
+ * statusgrammar.cpp such as
+ *
+ *   "%name %beam? %date %time UTC Act %activity: %state Sky: %sky MHz Chan: %channel"
+ *
+ * where each word is either a literal word that must appear or a %
+ * field, optional if followed by '?'. A trailing ':' on a field is a
+ * literal that must follow the value. %state takes the words up to the
+ * next literal. The rules are compiled into element lists once, and a
+ * line is matched against the rules for its kind of component in
+ * order until one fits the whole line, so a change to the format of
+ * the file is an edit to one rule.
+ *
+ * The state text is turned into a component_state_t from a table of
+ * the known phrases.
+ *
+ * The rules are shared. Each StatusGrammar keeps only the time it
+ * converted last, as every line of a record has the same time, so
+ * each reader of a status file should have its own.
+ */
+class StatusGrammar
+{
+    public:
+
+        /** Constructor. */
+        StatusGrammar();
+
+        /**
+         * Match a line against the rules for its kind of component.
+         *
+         * @param kind the ComponentStatus::component_kind_t of the line,
+         * kind_unknown for the "NSS" record header.
+         * @param line the start of the line.
+         * @param length the length of the line.
+         * @param fields set to the fields of the line.
+         * @return true if a rule matched the whole line, else false.
+         */
+        bool match(int kind, const char *line, size_t length, StatusLine &fields);
+
+        /**
+         * Get the state named by the state text of a line.
+         *
+         * @param kind the ComponentStatus::component_kind_t of the line.
+         * @param text the state text.
+         * @param length the length of the state text.
+         * @return the ComponentStatus::component_state_t value,
+         * state_last if the phrase is not known.
+         */
+        static int parseState(int kind, const char *text, size_t length);
+
+    private:
+
+        /**
+         * The kinds of element in a compiled rule.
+         */
+        enum element_t
+        {
+            element_literal,
+            element_name,
+            element_beam,
+            element_date,
+            element_time,
+            element_activity,
+            element_sky,
+            element_channel,
+            element_state
+        };
+
+        /**
+         * One word of a compiled rule.
+         */
+        struct Element
+        {
+            /** The element_t. */
+            int type;
+            /** The word, for element_literal. */
+            string literal;
+            /** A character that must follow the value, 0 if none. */
+            char suffix;
+            /** True if the element may be left out. */
+            bool optional;
+        };
+
+        /**
+         * A compiled rule.
+         */
+        struct Rule
+        {
+            /** The ComponentStatus::component_kind_t it is for. */
+            int kind;
+            /** The elements, in order. */
+            vector<Element> elements;
+        };
+
+        /**
+         * Compile the rule table.
+         */
+        static const vector<Rule> &getRules();
+
+        /**
+         * Match a line against one rule.
+         */
+        bool matchRule(const Rule &rule, const char *line, const char *end,
+                StatusLine &fields);
+
+        /**
+         * Match one word against one element that is not element_state.
+         */
+        static bool matchWord(const Element &element, const char *word,
+                const char *wordEnd, StatusLine &fields);
+
+        /** The date and time of the last time converted, "YYYY-MM-DDHH:MM:SS". */
+        char m_lastDateTime[18];
+
+        /** The last time converted. */
+        time_t m_lastTimestamp;
+};
+
+#endif //STATUSGRAMMAR_H
@@ -0,0 +1,151 @@
+/*
+ * statusgrammarcheck.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Checks the reading of status lines.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file statusgrammarcheck.cpp
+ * Checks the reading of status lines.
+ *
+ * Build and run with "make check". The lines are given as fgets()
+ * returns them, with their line endings, and are read both by
+ * StatusGrammar alone and by Components, also past a full
+ * ComponentRegistry. Prints each check that fails and exits with 1
+ * if any did.
+ */
+
+#include "components.h"
+#include "statusgrammar.h"
+#include "componentregistry.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+/** The number of checks that failed. */
+static int failures = 0;
+
+/** Report a check that failed. */
+static void check(bool ok, const char *what)
+{
+    if(ok) return;
+    printf("FAILED: %s\n", what);
+    failures++;
+}
+
+/** Check a dx read from a status line. */
+static void checkDx(const ComponentStatus &dx, const char *what)
+{
+    char text[128];
+
+    snprintf(text, sizeof(text), "%s: activity", what);
+    check(dx.activityId == 2735, text);
+    snprintf(text, sizeof(text), "%s: state", what);
+    check(dx.state == ComponentStatus::state_init, text);
+    snprintf(text, sizeof(text), "%s: sky frequency", what);
+    check(fabs(dx.skyFreqMHz - 8424.914) < 0.001, text);
+    snprintf(text, sizeof(text), "%s: channel", what);
+    check(dx.channel == 13, text);
+    snprintf(text, sizeof(text), "%s: time", what);
+    check(dx.timestamp == 1281140374, text);
+}
+
+int main()
+{
+    StatusGrammar grammar;
+    StatusLine fields;
+    const char *dx = "dx1001 (beam1) 2010-08-07 00:19:34 UTC  Act 2735: Init  Sky: 8424.914 MHz Chan: 13\n";
+    const char *dxCrLf = "dx1001 (beam1) 2010-08-07 00:19:34 UTC  Act 2735: Init  Sky: 8424.914 MHz Chan: 13\r\n";
+
+    //The grammar alone, line endings and all.
+    check(grammar.match(ComponentStatus::kind_dx, dx, strlen(dx), fields),
+            "dx line with '\\n' matches");
+    check(fields.rule == 0, "dx line with '\\n' matches the full rule");
+    check(fields.channel == 13, "dx line with '\\n' channel");
+    check(fabs(fields.skyFreqMHz - 8424.914) < 0.001, "dx line with '\\n' sky frequency");
+    check(grammar.match(ComponentStatus::kind_dx, dxCrLf, strlen(dxCrLf), fields) &&
+            fields.channel == 13, "dx line with \"\\r\\n\" channel");
+
+    //Whole records through Components, with a bare "NSS" header.
+    Components components;
+    const char *record[] = {
+        "NSS 2010-08-07 00:19:34 UTC\n",
+        "chan1x  2010-08-07 00:19:34 UTC Run\n",
+        dx,
+        "dx1002 (beam2) 2010-08-07 00:19:34 UTC  Act 2735: Init  Sky: 8424.914 MHz Chan: 13 Extra\n",
+        "dx1003 2010-08-07 00:19:34 UTC  Activity #2735 Init, Sky: 8424.914 MHz Chan: 13\n",
+        "====================================================\n"
+    };
+    int count = sizeof(record) / sizeof(record[0]);
+    bool complete = false;
+    for(int pass = 0; pass < 2; pass++)
+        for(int i = 0; i < count; i++) complete = components.addWithFilter(record[i]);
+
+    const vector<ComponentStatus> &parsed = components.getRecord();
+    check(complete, "the \"=====\" line ends the record");
+    check(parsed.size() == 4, "a bare \"NSS\" header starts a new record");
+    check(components.getRecordTime() == 1281140374, "the record time");
+    if(parsed.size() == 4)
+    {
+        check(parsed[0].state == ComponentStatus::state_running, "chan1x state");
+        checkDx(parsed[1], "dx1001, from the grammar");
+        checkDx(parsed[2], "dx1002, a line the grammar does not know");
+        check(parsed[3].activityId == -1, "dx1003 activity is not found");
+        check(parsed[3].channel == 13, "dx1003 channel, a line the grammar does not know");
+    }
+
+    StatusFeedHeader header = components.getRecordHeader();
+    check(header.minDxFreqMHz > 8424.0 && header.maxDxFreqMHz < 8425.0,
+            "the dx frequency range");
+
+    //Long names that differ past what ComponentStatus keeps.
+    ComponentRegistry registry;
+    check(registry.intern("dxlongsitename0001") != registry.intern("dxlongsitename0002"),
+            "long names that share their start get their own ids");
+
+    //More components than the registry holds are still read.
+    Components many;
+    many.addWithFilter("NSS  2010-08-07 00:19:34 UTC  Status\n");
+    char line[128];
+    for(int i = 0; i < COMPONENT_REGISTRY_MAX + 2; i++)
+    {
+        snprintf(line, sizeof(line), "dx%d (beam1) 2010-08-07 00:19:34 UTC  Offline\n", i);
+        many.addWithFilter(line);
+    }
+    many.addWithFilter("=====================================\n");
+    const vector<ComponentStatus> &all = many.getRecord();
+    check(all.size() == COMPONENT_REGISTRY_MAX + 2, "lines past a full registry are kept");
+    if(all.size() == COMPONENT_REGISTRY_MAX + 2)
+    {
+        const ComponentStatus &last = all.back();
+        check(last.kind == ComponentStatus::kind_dx &&
+                last.state == ComponentStatus::state_offline &&
+                strcmp(last.name, "dx4097") == 0, "a line past a full registry is read");
+    }
+
+    if(failures == 0) printf("All status line checks passed.\n");
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+/*
+ * stringpool.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Stores each distinct string once.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file stringpool.cpp
+ * Stores each distinct string once.
+ */
+
+#include "stringpool.h"
+
+/*
+ * Constructor. Id 0 is the empty string.
+ */
+StringPool::StringPool()
+{
+    intern("");
+}
+
+/*
+ * Get the id of a string, adding it if it is new.
+ *
+ * @param text the string.
+ * @return the id.
+ */
+uint32_t StringPool::intern(const string &text)
+{
+    map<string, uint32_t>::iterator it = m_ids.lower_bound(text);
+    if(it != m_ids.end() && it->first == text) return it->second;
+
+    uint32_t id = (uint32_t)m_strings.size();
+    it = m_ids.insert(it, std::pair<string, uint32_t>(text, id));
+    m_strings.push_back(&it->first);
+    return id;
+}
+
+/*
+ * Find the id of a string without adding it.
+ *
+ * @param text the string.
+ * @param id set to the id if found.
+ * @return true if found, else false.
+ */
+bool StringPool::find(const string &text, uint32_t &id) const
+{
+    map<string, uint32_t>::const_iterator it = m_ids.find(text);
+    if(it == m_ids.end()) return false;
+
+    id = it->second;
+    return true;
+}
+
+/*
+ * Get a string.
+ *
+ * @param id the id.
+ * @return the string, "" if the id is unknown.
+ */
+const string &StringPool::get(uint32_t id) const
+{
+    if(id >= m_strings.size()) return *m_strings[0];
+    return *m_strings[id];
+}
+
+/*
+ * Get the number of strings.
+ *
+ * @return the number of strings.
+ */
+uint32_t StringPool::size() const
+{
+    return (uint32_t)m_strings.size();
+}
@@ -0,0 +1,103 @@
+/*
+ * stringpool.h
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Stores each distinct string once.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file stringpool.h
+ * Stores each distinct string once.
+ */
+
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+using namespace std;
+
+/**
+ * Stores each distinct string once and refers to it by a small id.
+ *
+ * Log files repeat the same few component names and messages all day,
+ * so records that hold ids instead of strings are small, compare in one
+ * instruction, and can be displayed without copying. Strings are never
+ * removed, and a string returned by get() stays valid as long as the
+ * pool.
+ */
+class StringPool
+{
+    public:
+
+        /** Constructor. Id 0 is the empty string. */
+        StringPool();
+
+        /**
+         * Get the id of a string, adding it if it is new.
+         *
+         * @param text the string.
+         * @return the id.
+         */
+        uint32_t intern(const string &text);
+
+        /**
+         * Find the id of a string without adding it.
+         *
+         * @param text the string.
+         * @param id set to the id if found.
+         * @return true if found, else false.
+         */
+        bool find(const string &text, uint32_t &id) const;
+
+        /**
+         * Get a string.
+         *
+         * @param id the id.
+         * @return the string, "" if the id is unknown.
+         */
+        const string &get(uint32_t id) const;
+
+        /**
+         * Get the number of strings.
+         *
+         * @return the number of strings.
+         */
+        uint32_t size() const;
+
+    private:
+
+        /** The ids by string. The keys are the only copy of each string. */
+        map<string, uint32_t> m_ids;
+
+        /** The strings by id, pointing at the keys of m_ids. */
+        vector<const string *> m_strings;
+};
+
+#endif //STRINGPOOL_H
+
@@ -0,0 +1,471 @@
+/*
+ * summary.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Keeps hourly and nightly summaries of the observing.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file summary.cpp
+ * Keeps hourly and nightly summaries of the observing.
+ */
+
+#include "summary.h"
+#include "utils.h"
+#include <ncurses.h>
+#include <stdio.h>
+#include <string.h>
+
+/** Rows above the table: time and title, legend, column headings. */
+#define SUMMARY_HEADER_ROWS 3
+
+/** Longer gaps between records are not counted as time offline. */
+#define SUMMARY_MAX_GAP 60
+
+#define SUMMARY_HOUR_SECONDS 3600
+#define SUMMARY_NIGHT_SECONDS 86400
+#define SUMMARY_NIGHT_OFFSET (SUMMARY_NIGHT_START_HOUR * SUMMARY_HOUR_SECONDS)
+
+/*
+ * Constructor. Initializes an unused bucket.
+ */
+SummaryBucket::SummaryBucket()
+{
+    reset(0);
+}
+
+/*
+ * Empty the bucket and give it a new start time.
+ *
+ * @param bucketStart the UTC start of the hour or night.
+ */
+void SummaryBucket::reset(time_t bucketStart)
+{
+    start = bucketStart;
+    activities = 0;
+    candidates = 0;
+    offlineSeconds = 0;
+    coveredMHz = 0.0;
+    minFreqMHz = 0.0;
+    maxFreqMHz = 0.0;
+    memset(stateSeconds, 0, sizeof(stateSeconds));
+    memset(stateCount, 0, sizeof(stateCount));
+}
+
+/*
+ * Get the mean time a dx spent in a state.
+ *
+ * @param state the component_state_t value.
+ * @return the mean in seconds, -1 if no dx left the state.
+ */
+double SummaryBucket::getMeanSeconds(int state) const
+{
+    if(state < 0 || state >= ComponentStatus::state_last) return -1.0;
+    if(stateCount[state] == 0) return -1.0;
+    return (double)stateSeconds[state] / stateCount[state];
+}
+
+/*
+ * Constructor.
+ */
+Summary::Summary() : Details()
+{
+    m_thisType = detail_summary;
+    m_recordTime = 0;
+    m_offlineDxs = 0;
+    m_lastCompleted = -1;
+    m_spanActivity = -1;
+    m_spanMinMHz = 0.0;
+    m_spanMaxMHz = 0.0;
+    m_lastRequestedPage = -1;
+    m_showNights = false;
+}
+
+/*
+ * Update the counters from a complete status record.
+ *
+ * @param recordTime the UTC time of the record.
+ * @param header the record header, for the activity and the dx
+ * frequency range.
+ * @param record the parsed components of the record.
+ */
+void Summary::addRecord(time_t recordTime, const StatusFeedHeader &header,
+        const vector<ComponentStatus> &record)
+{
+    if(recordTime <= 0) return;
+
+    SummaryBucket &hour = hourOf(recordTime);
+    SummaryBucket &night = nightOf(recordTime);
+
+    //The dxs that were offline up to this record.
+    if(m_recordTime > 0 && recordTime > m_recordTime &&
+            recordTime - m_recordTime <= SUMMARY_MAX_GAP)
+    {
+        uint32_t seconds = (uint32_t)(m_offlineDxs * (recordTime - m_recordTime));
+        hour.offlineSeconds += seconds;
+        night.offlineSeconds += seconds;
+    }
+    m_recordTime = recordTime;
+
+    //The dx frequency range of the current activity.
+    if(header.activityId != m_spanActivity)
+    {
+        m_spanActivity = header.activityId;
+        m_spanMinMHz = 0.0;
+        m_spanMaxMHz = 0.0;
+    }
+    if(header.minDxFreqMHz > 0.0)
+    {
+        if(m_spanMinMHz == 0.0 || header.minDxFreqMHz < m_spanMinMHz)
+            m_spanMinMHz = header.minDxFreqMHz;
+        if(header.maxDxFreqMHz > m_spanMaxMHz) m_spanMaxMHz = header.maxDxFreqMHz;
+
+        SummaryBucket *buckets[2] = { &hour, &night };
+        for(int i = 0; i < 2; i++)
+        {
+            if(buckets[i]->minFreqMHz == 0.0 || header.minDxFreqMHz < buckets[i]->minFreqMHz)
+                buckets[i]->minFreqMHz = header.minDxFreqMHz;
+            if(header.maxDxFreqMHz > buckets[i]->maxFreqMHz)
+                buckets[i]->maxFreqMHz = header.maxDxFreqMHz;
+        }
+    }
+
+    m_offlineDxs = 0;
+    for(int i = 0; i < (int)record.size(); i++)
+    {
+        const ComponentStatus &status = record[i];
+        if(status.kind != ComponentStatus::kind_dx) continue;
+
+        if(status.state == ComponentStatus::state_offline) m_offlineDxs++;
+
+        //The first dx to finish signal detection completes the activity.
+        if(status.activityId > m_lastCompleted &&
+                (status.state == ComponentStatus::state_sig_det_complete ||
+                 status.state == ComponentStatus::state_complete))
+        {
+            m_lastCompleted = status.activityId;
+            hour.activities++;
+            night.activities++;
+            if(status.activityId == m_spanActivity)
+            {
+                hour.coveredMHz += m_spanMaxMHz - m_spanMinMHz;
+                night.coveredMHz += m_spanMaxMHz - m_spanMinMHz;
+            }
+        }
+
+        int id = m_registry.intern(status.name, strnlen(status.name, sizeof(status.name)));
+        if(id < 0) continue;
+        if(id >= (int)m_dxs.size())
+        {
+            //First sighting, the time it entered this state is unknown.
+            DxTrack track;
+            track.state = status.state;
+            track.activityId = status.activityId;
+            track.enteredAt = recordTime;
+            track.entryKnown = false;
+            m_dxs.push_back(track);
+            continue;
+        }
+
+        DxTrack &track = m_dxs[id];
+
+        //The file was restarted or is being replayed from the top.
+        if(recordTime < track.enteredAt)
+        {
+            track.state = status.state;
+            track.activityId = status.activityId;
+            track.enteredAt = recordTime;
+            track.entryKnown = false;
+            if(status.activityId < m_lastCompleted) m_lastCompleted = -1;
+            continue;
+        }
+
+        if(track.state == status.state && track.activityId == status.activityId)
+            continue;
+
+        if(track.entryKnown && track.state < ComponentStatus::state_last)
+        {
+            uint32_t seconds = (uint32_t)(recordTime - track.enteredAt);
+            hour.stateSeconds[track.state] += seconds;
+            hour.stateCount[track.state]++;
+            night.stateSeconds[track.state] += seconds;
+            night.stateCount[track.state]++;
+        }
+
+        track.state = status.state;
+        track.activityId = status.activityId;
+        track.enteredAt = recordTime;
+        track.entryKnown = true;
+    }
+}
+
+/*
+ * Count a candidate signal, at the time of the last status record.
+ */
+void Summary::addCandidate()
+{
+    if(m_recordTime <= 0) return;
+
+    hourOf(m_recordTime).candidates++;
+    nightOf(m_recordTime).candidates++;
+}
+
+/*
+ * Get the hour bucket for a time, starting a new hour if needed.
+ */
+SummaryBucket &Summary::hourOf(time_t when)
+{
+    long hour = (long)(when / SUMMARY_HOUR_SECONDS);
+    SummaryBucket &bucket = m_hours[hour % SUMMARY_HOURS];
+
+    time_t start = (time_t)hour * SUMMARY_HOUR_SECONDS;
+    if(bucket.start != start) bucket.reset(start);
+    return bucket;
+}
+
+/*
+ * Get the night bucket for a time, starting a new night if needed.
+ */
+SummaryBucket &Summary::nightOf(time_t when)
+{
+    long night = (long)((when - SUMMARY_NIGHT_OFFSET) / SUMMARY_NIGHT_SECONDS);
+    SummaryBucket &bucket = m_nights[night % SUMMARY_NIGHTS];
+
+    time_t start = (time_t)night * SUMMARY_NIGHT_SECONDS + SUMMARY_NIGHT_OFFSET;
+    if(bucket.start != start) bucket.reset(start);
+    return bucket;
+}
+
+/*
+ * Get the bucket of an hour.
+ *
+ * @param age 0 for the current hour, 1 for the one before, up to
+ * SUMMARY_HOURS-1.
+ * @return the bucket, its start is 0 if there was no data.
+ */
+const SummaryBucket &Summary::getHour(int age) const
+{
+    static const SummaryBucket empty;
+
+    long hour = (long)(m_recordTime / SUMMARY_HOUR_SECONDS) - age;
+    if(m_recordTime <= 0 || age < 0 || age >= SUMMARY_HOURS || hour < 0) return empty;
+
+    const SummaryBucket &bucket = m_hours[hour % SUMMARY_HOURS];
+    if(bucket.start != (time_t)hour * SUMMARY_HOUR_SECONDS) return empty;
+    return bucket;
+}
+
+/*
+ * Get the bucket of a night.
+ *
+ * @param age 0 for the current night, 1 for the one before, up to
+ * SUMMARY_NIGHTS-1.
+ * @return the bucket, its start is 0 if there was no data.
+ */
+const SummaryBucket &Summary::getNight(int age) const
+{
+    static const SummaryBucket empty;
+
+    long night = (long)((m_recordTime - SUMMARY_NIGHT_OFFSET) / SUMMARY_NIGHT_SECONDS) - age;
+    if(m_recordTime <= 0 || age < 0 || age >= SUMMARY_NIGHTS || night < 0) return empty;
+
+    const SummaryBucket &bucket = m_nights[night % SUMMARY_NIGHTS];
+    if(bucket.start != (time_t)night * SUMMARY_NIGHT_SECONDS + SUMMARY_NIGHT_OFFSET)
+        return empty;
+    return bucket;
+}
+
+/*
+ * Format a mean time in state into a table cell.
+ */
+string Summary::formatMean(const SummaryBucket &bucket, int state)
+{
+    double mean = bucket.getMeanSeconds(state);
+    if(mean < 0.0) return "-";
+
+    char cell[32];
+    snprintf(cell, sizeof(cell), "%.1f", mean);
+    return cell;
+}
+
+/*
+ * Display the information on the screen.
+ *
+ * @param pageNum the page number to display.
+ * @param pageCols the number of columns on the screen.
+ * @param pageRows the number of rows on the screen.
+ * @return true if screen has changed, else false.
+ */
+bool Summary::paint(int pageNum, int pageCols, int pageRows)
+{
+    char tempLine[256];
+    string blank(pageCols, ' ');
+    string line;
+
+    if(pageNum > getNumPages(pageRows)) pageNum = getNumPages(pageRows);
+    m_lastRequestedPage = pageNum;
+
+    //Draw the header
+    string headerString = m_showNights ? "SonATA Nightly Summary" : "SonATA Hourly Summary";
+    move(0,0);
+    addstr(blank.c_str());
+    move(0,0);
+    if(m_recordTime > 0)
+    {
+        struct tm t;
+        gmtime_r(&m_recordTime, &t);
+        strftime(tempLine, sizeof(tempLine), "%H:%M:%S UTC", &t);
+        addstr(tempLine);
+    }
+    Utils::drawColorText(0, pageCols/2 - headerString.size()/2, 3, headerString);
+
+    move(1,0);
+    if(m_showNights)
+        snprintf(tempLine, sizeof(tempLine),
+                "Nights from %02d:00 UTC, newest first. Mean seconds in state. n=Hours",
+                SUMMARY_NIGHT_START_HOUR);
+    else
+        snprintf(tempLine, sizeof(tempLine),
+                "Hours, newest first. Mean seconds in state. n=Nights");
+    line = tempLine;
+    line.resize(pageCols, ' ');
+    addstr(line.c_str());
+
+    snprintf(tempLine, sizeof(tempLine), "%-16s %5s %8s %7s %7s %7s %8s %9s  %s",
+            "Start UTC", "Acts", "Cand/Act", "Base", "Data", "SigDet",
+            "Off Min", "Band MHz", "Freq MHz");
+    line = tempLine;
+    line.resize(pageCols, ' ');
+    Utils::drawColorText(2, 0, 2, line);
+
+    int realRows = pageRows - SUMMARY_HEADER_ROWS;
+    int age = (pageNum-1) * realRows;
+
+    for(int i = 0; i < realRows; i++, age++)
+    {
+        int row = SUMMARY_HEADER_ROWS + i;
+        const SummaryBucket &bucket = m_showNights ? getNight(age) : getHour(age);
+
+        move(row, 0);
+        addstr(blank.c_str());
+        if(bucket.start == 0) continue;
+
+        char start[32];
+        struct tm t;
+        gmtime_r(&bucket.start, &t);
+        strftime(start, sizeof(start), "%Y-%m-%d %H:%M", &t);
+
+        string perActivity = "-";
+        if(bucket.activities > 0)
+        {
+            snprintf(tempLine, sizeof(tempLine), "%.1f",
+                    (double)bucket.candidates / bucket.activities);
+            perActivity = tempLine;
+        }
+
+        string range = "-";
+        if(bucket.maxFreqMHz > 0.0)
+        {
+            snprintf(tempLine, sizeof(tempLine), "%.1f-%.1f",
+                    bucket.minFreqMHz, bucket.maxFreqMHz);
+            range = tempLine;
+        }
+
+        snprintf(tempLine, sizeof(tempLine), "%-16s %5u %8s %7s %7s %7s %8u %9.1f  %s",
+                start, (unsigned int)bucket.activities, perActivity.c_str(),
+                formatMean(bucket, ComponentStatus::state_base_accum).c_str(),
+                formatMean(bucket, ComponentStatus::state_data_coll).c_str(),
+                formatMean(bucket, ComponentStatus::state_sig_det).c_str(),
+                (unsigned int)(bucket.offlineSeconds / 60), bucket.coveredMHz,
+                range.c_str());
+        line = tempLine;
+        line.resize(pageCols, ' ');
+
+        if(age == 0)
+            Utils::drawColorText(row, 0, 5, line);
+        else
+        {
+            move(row, 0);
+            addstr(line.c_str());
+        }
+    }
+
+    //Park the cursor in the lower right corner
+    move(pageRows-1, pageCols-1);
+
+    return true;
+}
+
+/*
+ * Handle a key press. 'n' switches between the hours and the
+ * nights.
+ *
+ * @param ch the key, as returned by getch().
+ * @return true if the screen should be repainted, else false.
+ */
+bool Summary::processKey(int ch)
+{
+    if(ch != 'n') return false;
+
+    m_showNights = !m_showNights;
+    return true;
+}
+
+/*
+ * Get the number of pages required to display all the information.
+ *
+ * @param pageRows the number of rows available on the screen.
+ * @return the number of pages required to display all the
+ * information.
+ */
+int Summary::getNumPages(int pageRows)
+{
+    int realRows = pageRows - SUMMARY_HEADER_ROWS;
+    if(realRows < 1) return 1;
+
+    int rows = m_showNights ? SUMMARY_NIGHTS : SUMMARY_HOURS;
+    return (rows - 1) / realRows + 1;
+}
+
+/*
+ * Get the type of this object inherited from the Details class.
+ *
+ * @return the type as a detail_t enum value.
+ */
+int Summary::getType()
+{
+    return m_thisType;
+}
+
+/*
+ * Get the current page number displayed.
+ *
+ * @return the current page number displayed.
+ */
+int Summary::getCurrentPageNumber()
+{
+    if(m_lastRequestedPage <= 0) return 1;
+    return m_lastRequestedPage;
+}
@@ -0,0 +1,253 @@
+/*
+ * summary.h
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Keeps hourly and nightly summaries of the observing.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file summary.h
+ * Keeps hourly and nightly summaries of the observing.
+ */
+
+#ifndef SUMMARY_H
+#define SUMMARY_H
+
+#include "details.h"
+#include "componentstatus.h"
+#include "statusfeed.h"
+#include "componentregistry.h"
+#include <vector>
+
+using namespace std;
+
+/** The number of hours kept in the hourly summary. */
+#define SUMMARY_HOURS 48
+
+/** The number of nights kept in the nightly summary. */
+#define SUMMARY_NIGHTS 14
+
+/**
+ * The UTC hour an observing night starts, noon in California. A night
+ * is the 24 hours from then.
+ */
+#define SUMMARY_NIGHT_START_HOUR 20
+
+/**
+ * The counters of one hour or one night.
+ */
+struct SummaryBucket
+{
+    /** The UTC start of the hour or night, 0 if the bucket is unused. */
+    time_t start;
+    /** The number of activities that completed. */
+    uint32_t activities;
+    /** The number of candidate signals reported. */
+    uint32_t candidates;
+    /** The dx seconds spent offline. */
+    uint32_t offlineSeconds;
+    /** The sum of the dx frequency spans of the completed activities, MHz. */
+    double coveredMHz;
+    /** The lowest dx sky frequency seen, MHz. 0 if none. */
+    float minFreqMHz;
+    /** The highest dx sky frequency seen, MHz. 0 if none. */
+    float maxFreqMHz;
+    /** The dx seconds spent in each component_state_t, for the states left. */
+    uint32_t stateSeconds[ComponentStatus::state_last];
+    /** The number of times a dx left each component_state_t. */
+    uint32_t stateCount[ComponentStatus::state_last];
+
+    /** Constructor. Initializes an unused bucket. */
+    SummaryBucket();
+
+    /**
+     * Empty the bucket and give it a new start time.
+     *
+     * @param bucketStart the UTC start of the hour or night.
+     */
+    void reset(time_t bucketStart);
+
+    /**
+     * Get the mean time a dx spent in a state.
+     *
+     * @param state the component_state_t value.
+     * @return the mean in seconds, -1 if no dx left the state.
+     */
+    double getMeanSeconds(int state) const;
+};
+
+/**
+ * Keeps running counters of the observing for each hour and each
+ * night, and displays them on the summary screen: activities completed,
+ * candidates per activity, the mean time the dxs spend in the activity
+ * states, dx minutes offline and the bandwidth covered.
+ *
+ * The counters live in two fixed rings of SummaryBucket, SUMMARY_HOURS
+ * hours and SUMMARY_NIGHTS nights. Each event adds to the bucket of the
+ * hour and the night it happened in, reusing the oldest bucket when a
+ * new hour or night starts, so an update costs the same and the screen
+ * draws as quickly after a month as after a minute. As in Activities,
+ * the times are taken from the status records, not the wall clock.
+ *
+ * Inherits from the Details class.
+ */
+class Summary: public Details
+{
+    public:
+
+        /** Constructor. */
+        Summary();
+
+        /**
+         * Update the counters from a complete status record.
+         *
+         * @param recordTime the UTC time of the record.
+         * @param header the record header, for the activity and the dx
+         * frequency range.
+         * @param record the parsed components of the record.
+         */
+        void addRecord(time_t recordTime, const StatusFeedHeader &header,
+                const vector<ComponentStatus> &record);
+
+        /**
+         * Count a candidate signal, at the time of the last status record.
+         */
+        void addCandidate();
+
+        /**
+         * Get the bucket of an hour.
+         *
+         * @param age 0 for the current hour, 1 for the one before, up to
+         * SUMMARY_HOURS-1.
+         * @return the bucket, its start is 0 if there was no data.
+         */
+        const SummaryBucket &getHour(int age) const;
+
+        /**
+         * Get the bucket of a night.
+         *
+         * @param age 0 for the current night, 1 for the one before, up to
+         * SUMMARY_NIGHTS-1.
+         * @return the bucket, its start is 0 if there was no data.
+         */
+        const SummaryBucket &getNight(int age) const;
+
+        /**
+         * Get the number of pages required to display all the information.
+         *
+         * @param pageRows the number of rows available on the screen.
+         * @return the number of pages required to display all the
+         * information.
+         */
+        int getNumPages(int pageRows);
+
+        /**
+         * Get the type of this object inherited from the Details class.
+         *
+         * @return the type as a detail_t enum value.
+         */
+        int getType();
+
+        /**
+         * Get the current page number displayed.
+         *
+         * @return the current page number displayed.
+         */
+        int getCurrentPageNumber();
+
+        /**
+         * Display the information on the screen.
+         *
+         * @param pageNum the page number to display.
+         * @param pageCols the number of columns on the screen.
+         * @param pageRows the number of rows on the screen.
+         * @return true if screen has changed, else false.
+         */
+        bool paint(int pageNum, int pageCols, int pageRows);
+
+        /**
+         * Handle a key press. 'n' switches between the hours and the
+         * nights.
+         *
+         * @param ch the key, as returned by getch().
+         * @return true if the screen should be repainted, else false.
+         */
+        bool processKey(int ch);
+
+    private:
+
+        /**
+         * What is known of one dx between records.
+         */
+        struct DxTrack
+        {
+            /** The current state. */
+            int state;
+            /** The current activity id. */
+            int activityId;
+            /** When the current state was entered. */
+            time_t enteredAt;
+            /** False until the dx has been seen entering a state. */
+            bool entryKnown;
+        };
+
+        /**
+         * Get the hour bucket for a time, starting a new hour if needed.
+         */
+        SummaryBucket &hourOf(time_t when);
+
+        /**
+         * Get the night bucket for a time, starting a new night if needed.
+         */
+        SummaryBucket &nightOf(time_t when);
+
+        /**
+         * Format a mean time in state into a table cell.
+         */
+        static string formatMean(const SummaryBucket &bucket, int state);
+
+        SummaryBucket m_hours[SUMMARY_HOURS];
+        SummaryBucket m_nights[SUMMARY_NIGHTS];
+
+        /** The dxs by id in m_registry, for the time in state. */
+        ComponentRegistry m_registry;
+        vector<DxTrack> m_dxs;
+
+        time_t m_recordTime;
+        int m_offlineDxs;
+
+        /** The newest activity counted as completed. */
+        int m_lastCompleted;
+
+        /** The activity whose dx frequency range is being tracked. */
+        int m_spanActivity;
+        float m_spanMinMHz;
+        float m_spanMaxMHz;
+
+        int m_lastRequestedPage;
+        bool m_showNights;
+};
+
+#endif //SUMMARY_H
@@ -33,6 +33,21 @@
  **/
 
 #include "utils.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/** Exact powers of 10 as doubles. */
+static const double POWERS_OF_10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/** The largest exponent in POWERS_OF_10. */
+#define UTILS_MAX_EXACT_POWER 22
+
+/** Integers up to this are exact in a double. */
+#define UTILS_MAX_EXACT_MANTISSA (1ULL << 53)
 
 /*
  * Constructor
@@ -58,9 +73,8 @@ Utils::~Utils()
  */
 string Utils::itos(unsigned long int num)
 {
-    stringstream s;
-    s << num;
-    return s.str();
+    char buffer[24];
+    return string(buffer, formatInt(buffer, buffer + sizeof(buffer), num));
 }
 
 /*
@@ -71,9 +85,7 @@ string Utils::itos(unsigned long int num)
  */
 string Utils::itos(unsigned int num)
 {
-    stringstream s;
-    s << num;
-    return s.str();
+    return itos((unsigned long)num);
 }
 
 /*
@@ -84,9 +96,8 @@ string Utils::itos(unsigned int num)
  */
 string Utils::itos(int num)
 {
-    stringstream s;
-    s << num;
-    return s.str();
+    char buffer[24];
+    return string(buffer, formatInt(buffer, buffer + sizeof(buffer), (long)num));
 }
 
 /*
@@ -97,23 +108,261 @@ string Utils::itos(int num)
  */
 string Utils::ftos(float num)
 {
-    stringstream s;
-    s << num;
-    return s.str();
+    char buffer[32];
+
+    //What a stream gives, 6 significant digits with an exponent outside
+    //1e-4 to 1e6. The display never calls setlocale(), so the point is '.'.
+    snprintf(buffer, sizeof(buffer), "%g", num);
+    return buffer;
 }
 
 /*
  * Convert a string to a float.
  *
  * @param num the number string to convert.
- * @return the resulting float
+ * @return the resulting float, 0 if it is not a number.
+ */
+float Utils::stof(const string &num)
+{
+    double value = 0.0;
+    parseFloat(num.data(), num.data() + num.size(), value);
+    return (float)value;
+}
+
+/*
+ * Parse a decimal integer, without regard to the locale and
+ * without allocating. Leading blanks are skipped.
+ *
+ * @param text the start of the text.
+ * @param end the end of the text, need not be '\\0'.
+ * @param value set to the number, unchanged on error.
+ * @param next if not NULL, set to the first character after
+ * the number.
+ * @return false if there is no number or it does not fit.
+ */
+bool Utils::parseInt(const char *text, const char *end, long &value,
+        const char **next)
+{
+    while(text < end && (*text == ' ' || *text == '\t')) text++;
+
+    bool negative = false;
+    if(text < end && (*text == '-' || *text == '+'))
+    {
+        negative = (*text == '-');
+        text++;
+    }
+
+    //Accumulate as a negative number, which has the larger range.
+    const long lowest = (long)(~0UL >> 1) * -1 - 1;
+    const char *digits = text;
+    long number = 0;
+    for(; text < end && *text >= '0' && *text <= '9'; text++)
+    {
+        int digit = *text - '0';
+        if(number < (lowest + digit) / 10) return false;
+        number = number * 10 - digit;
+    }
+    if(text == digits) return false;
+
+    if(!negative)
+    {
+        if(number == lowest) return false;
+        number = -number;
+    }
+
+    value = number;
+    if(next != NULL) *next = text;
+    return true;
+}
+
+/*
+ * Parse a decimal number such as "-1420.125" or "1.5e3",
+ * without regard to the locale and without allocating. Leading
+ * blanks are skipped. Numbers of up to 15 significant digits
+ * with up to 22 decimals (all those in the SonATA logs) are
+ * converted exactly, longer ones to within a few units in the
+ * last place.
+ *
+ * @param text the start of the text.
+ * @param end the end of the text, need not be '\\0'.
+ * @param value set to the number, unchanged on error.
+ * @param next if not NULL, set to the first character after
+ * the number.
+ * @return false if there is no number or it is out of range.
+ */
+bool Utils::parseFloat(const char *text, const char *end, double &value,
+        const char **next)
+{
+    while(text < end && (*text == ' ' || *text == '\t')) text++;
+
+    bool negative = false;
+    if(text < end && (*text == '-' || *text == '+'))
+    {
+        negative = (*text == '-');
+        text++;
+    }
+
+    //Up to 19 significant digits are kept, the rest only scale.
+    uint64_t mantissa = 0;
+    int significant = 0;
+    int exponent = 0;
+    int digits = 0;
+    for(; text < end && *text >= '0' && *text <= '9'; text++, digits++)
+    {
+        if(significant < 19)
+        {
+            mantissa = mantissa * 10 + (*text - '0');
+            if(mantissa > 0) significant++;
+        }
+        else exponent++;
+    }
+    if(text < end && *text == '.')
+    {
+        for(text++; text < end && *text >= '0' && *text <= '9'; text++, digits++)
+        {
+            if(significant < 19)
+            {
+                mantissa = mantissa * 10 + (*text - '0');
+                if(mantissa > 0) significant++;
+                exponent--;
+            }
+        }
+    }
+    if(digits == 0) return false;
+
+    //An exponent only counts if it has digits.
+    if(text < end && (*text == 'e' || *text == 'E'))
+    {
+        long power = 0;
+        const char *after = NULL;
+        if(text + 1 < end && text[1] != ' ' && text[1] != '\t' &&
+                parseInt(text + 1, end, power, &after))
+        {
+            if(power > 1000 || power < -1000) return false;
+            exponent += (int)power;
+            text = after;
+        }
+    }
+
+    double number = (double)mantissa;
+    if(mantissa != 0 && exponent != 0)
+    {
+        if(mantissa <= UTILS_MAX_EXACT_MANTISSA && exponent < 0 &&
+                exponent >= -UTILS_MAX_EXACT_POWER)
+            number /= POWERS_OF_10[-exponent];
+        else if(mantissa <= UTILS_MAX_EXACT_MANTISSA && exponent > 0 &&
+                exponent <= UTILS_MAX_EXACT_POWER)
+            number *= POWERS_OF_10[exponent];
+        else if(exponent < -300)
+        {
+            //10^exponent alone would underflow before the mantissa counts.
+            number *= pow(10.0, exponent / 2);
+            number *= pow(10.0, exponent - exponent / 2);
+        }
+        else
+            number *= pow(10.0, exponent);
+
+        if(isinf(number)) return false;
+    }
+
+    value = negative ? -number : number;
+    if(next != NULL) *next = text;
+    return true;
+}
+
+/*
+ * Write an integer in decimal, not '\\0' terminated.
+ *
+ * @param buffer the start of the space to write to.
+ * @param end the end of the space.
+ * @param value the number.
+ * @return the end of what was written, NULL if it did not fit.
+ */
+char *Utils::formatInt(char *buffer, char *end, long value)
+{
+    if(value >= 0) return formatInt(buffer, end, (unsigned long)value);
+
+    if(buffer >= end) return NULL;
+    *buffer = '-';
+    return formatInt(buffer + 1, end, 0UL - (unsigned long)value);
+}
+
+/*
+ * Write an unsigned integer in decimal, not '\\0' terminated.
+ *
+ * @param buffer the start of the space to write to.
+ * @param end the end of the space.
+ * @param value the number.
+ * @return the end of what was written, NULL if it did not fit.
+ */
+char *Utils::formatInt(char *buffer, char *end, unsigned long value)
+{
+    //The digits come out last first.
+    char digits[24];
+    int count = 0;
+    do
+    {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while(value > 0);
+
+    if(end - buffer < count) return NULL;
+    while(count > 0) *buffer++ = digits[--count];
+    return buffer;
+}
+
+/*
+ * Write a number with a fixed number of decimals, not '\\0'
+ * terminated, without regard to the locale.
+ *
+ * @param buffer the start of the space to write to.
+ * @param end the end of the space.
+ * @param value the number.
+ * @param decimals the number of decimals, 0 to 9.
+ * @return the end of what was written, NULL if it did not fit
+ * or the number is too big (over 1e18 once scaled).
+ */
+char *Utils::formatFloat(char *buffer, char *end, double value, int decimals)
+{
+    if(decimals < 0 || decimals > 9 || value != value) return NULL;
+
+    bool negative = (value < 0.0);
+    double scaled = fabs(value) * POWERS_OF_10[decimals] + 0.5;
+    if(scaled >= 1e18) return NULL;
+
+    uint64_t number = (uint64_t)scaled;
+    uint64_t scale = (uint64_t)POWERS_OF_10[decimals];
+
+    if(negative && number > 0)
+    {
+        if(buffer >= end) return NULL;
+        *buffer++ = '-';
+    }
+
+    buffer = formatInt(buffer, end, (unsigned long)(number / scale));
+    if(buffer == NULL || decimals == 0) return buffer;
+
+    if(end - buffer < decimals + 1) return NULL;
+    *buffer++ = '.';
+    uint64_t fraction = number % scale;
+    for(int i = decimals - 1; i >= 0; i--)
+    {
+        buffer[i] = (char)('0' + fraction % 10);
+        fraction /= 10;
+    }
+    return buffer + decimals;
+}
+
+/*
+ * Append an integer in decimal to a string.
+ *
+ * @param text the string.
+ * @param value the number.
  */
-float Utils::stof(string num)
+void Utils::appendInt(string &text, long value)
 {
-    istringstream s(num);
-    float f;
-    s >> f;
-    return f;
+    char buffer[24];
+    text.append(buffer, formatInt(buffer, buffer + sizeof(buffer), value));
 }
 
 
@@ -124,7 +373,7 @@ float Utils::stof(string num)
  * @param fullstring the string to search from the beginning.
  * @return bool true if fullsting starts with substring.
  */
-bool Utils::startsWith(string substring, string fullstring)
+bool Utils::startsWith(const string &substring, const string &fullstring)
 {
     if(fullstring.compare((size_t)0, substring.size(), substring))
         return false;
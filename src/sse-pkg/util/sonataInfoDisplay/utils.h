@@ -97,9 +97,82 @@ using namespace std;
          * Convert a string to a float.
          *
          * @param num the number string to convert.
-         * @return the resulting float
+         * @return the resulting float, 0 if it is not a number.
          */
-        static float stof(string num);
+        static float stof(const string &num);
+
+        /**
+         * Parse a decimal integer, without regard to the locale and
+         * without allocating. Leading blanks are skipped.
+         *
+         * @param text the start of the text.
+         * @param end the end of the text, need not be '\\0'.
+         * @param value set to the number, unchanged on error.
+         * @param next if not NULL, set to the first character after
+         * the number.
+         * @return false if there is no number or it does not fit.
+         */
+        static bool parseInt(const char *text, const char *end, long &value,
+                const char **next = NULL);
+
+        /**
+         * Parse a decimal number such as "-1420.125" or "1.5e3",
+         * without regard to the locale and without allocating. Leading
+         * blanks are skipped. Numbers of up to 15 significant digits
+         * with up to 22 decimals (all those in the SonATA logs) are
+         * converted exactly, longer ones to within a few units in the
+         * last place.
+         *
+         * @param text the start of the text.
+         * @param end the end of the text, need not be '\\0'.
+         * @param value set to the number, unchanged on error.
+         * @param next if not NULL, set to the first character after
+         * the number.
+         * @return false if there is no number or it is out of range.
+         */
+        static bool parseFloat(const char *text, const char *end, double &value,
+                const char **next = NULL);
+
+        /**
+         * Write an integer in decimal, not '\\0' terminated.
+         *
+         * @param buffer the start of the space to write to.
+         * @param end the end of the space.
+         * @param value the number.
+         * @return the end of what was written, NULL if it did not fit.
+         */
+        static char *formatInt(char *buffer, char *end, long value);
+
+        /**
+         * Write an unsigned integer in decimal, not '\\0' terminated.
+         *
+         * @param buffer the start of the space to write to.
+         * @param end the end of the space.
+         * @param value the number.
+         * @return the end of what was written, NULL if it did not fit.
+         */
+        static char *formatInt(char *buffer, char *end, unsigned long value);
+
+        /**
+         * Write a number with a fixed number of decimals, not '\\0'
+         * terminated, without regard to the locale.
+         *
+         * @param buffer the start of the space to write to.
+         * @param end the end of the space.
+         * @param value the number.
+         * @param decimals the number of decimals, 0 to 9.
+         * @return the end of what was written, NULL if it did not fit
+         * or the number is too big (over 1e18 once scaled).
+         */
+        static char *formatFloat(char *buffer, char *end, double value, int decimals);
+
+        /**
+         * Append an integer in decimal to a string.
+         *
+         * @param text the string.
+         * @param value the number.
+         */
+        static void appendInt(string &text, long value);
 
         /**
          * Test to see if a string starts with a string.
@@ -108,7 +181,7 @@ using namespace std;
          * @param fullstring the string to search from the beginning.
          * @return bool true if fullsting starts with substring.
          */
-        static bool startsWith(string substring, string fullstring);
+        static bool startsWith(const string &substring, const string &fullstring);
 
         /**
          * Draw text on the curses screen with a color.
@@ -0,0 +1,246 @@
+/*
+ * utilsbench.cpp
+ *
+ * Project: OpenSonATA
+ * Version: 2.2
+ * Author:  Jon Richards (current maintainer)
+ *          The OpenSonATA code is the result of many programmers over many
+ *          years.
+ *
+ * Times the Utils number conversions against the stream ones they replaced.
+ *
+ * Copyright 2010 The SETI Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0 Unless required by
+ * applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ *
+ * Attribution must be: “Licensed through SETI” in all published
+ * uses of the software including analytics based on the software,
+ * combined and merged software, papers, articles, books, reports,
+ * web pages, etc.
+ */
+
+/**
+ * @file utilsbench.cpp
+ * Times the Utils number conversions against the stream ones they replaced.
+ *
+ * Build with "make bench" and run ./utilsbench. It checks that
+ * Utils::parseFloat() agrees with strtod() on the kind of numbers found
+ * in the status lines and past them, that parseInt() and parseFloat()
+ * handle overflow and partial numbers, and that Utils::ftos() matches
+ * the stream, then times the parsing of a sky frequency and the
+ * composing of a count both ways.
+ */
+
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <sys/time.h>
+#include <vector>
+
+/** The number of conversions timed for each method. */
+#define BENCH_COUNT 1000000
+
+/** The stringstream Utils::stof() that was used before. */
+static float streamStof(string num)
+{
+    istringstream s(num);
+    float f;
+    s >> f;
+    return f;
+}
+
+/** The stringstream Utils::itos() that was used before. */
+static string streamItos(int num)
+{
+    stringstream s;
+    s << num;
+    return s.str();
+}
+
+/** The stringstream Utils::ftos() that was used before. */
+static string streamFtos(float num)
+{
+    stringstream s;
+    s << num;
+    return s.str();
+}
+
+/** Check that parseInt() reads a number, or rejects it if ok is false. */
+static int checkInt(const char *text, bool ok, long expected, int length)
+{
+    long value = 0;
+    const char *next = NULL;
+    bool parsed = Utils::parseInt(text, text + strlen(text), value, &next);
+    if(parsed != ok || (ok && (value != expected || next != text + length)))
+    {
+        printf("parseInt(\"%s\") is wrong\n", text);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Check parseFloat() against strtod(), which must read as far. Past 15
+ * significant digits or 22 decimals a few units in the last place are
+ * allowed.
+ */
+static int checkFloat(const char *text, bool ok)
+{
+    double value = 0.0;
+    const char *next = NULL;
+    bool parsed = Utils::parseFloat(text, text + strlen(text), value, &next);
+
+    char *strtodEnd;
+    double expected = strtod(text, &strtodEnd);
+    if(parsed != ok || (ok && (next != strtodEnd ||
+                    fabs(value - expected) > fabs(expected) * 1e-15)))
+    {
+        printf("parseFloat(\"%s\") is wrong\n", text);
+        return 1;
+    }
+    return 0;
+}
+
+/** Get the time now in seconds. */
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+int main()
+{
+    vector<string> freqs;
+    char text[64];
+
+    //Sky frequencies and channels as they appear in the status lines.
+    srand(1);
+    for(int i = 0; i < 1000; i++)
+    {
+        snprintf(text, sizeof(text), "%.3f", 1000.0 + (rand() % 9000000) / 1000.0);
+        freqs.push_back(text);
+    }
+
+    //Check against strtod with more varied numbers.
+    int mismatches = 0;
+    for(int i = 0; i < 100000; i++)
+    {
+        double number = (rand() - RAND_MAX / 2) / (double)(1 + rand() % 100000);
+        snprintf(text, sizeof(text), (i % 2) ? "%.6f" : "%.9g", number);
+
+        double fast = 0.0;
+        const char *end = text;
+        while(*end) end++;
+        if(!Utils::parseFloat(text, end, fast) || fast != strtod(text, NULL))
+            mismatches++;
+    }
+
+    //Integers at and past the ends of a long, and no number at all.
+    char longest[32];
+    char tooBig[32];
+    char mostNegative[32];
+    snprintf(longest, sizeof(longest), "%ld", LONG_MAX);
+    snprintf(tooBig, sizeof(tooBig), "%lu", (unsigned long)LONG_MAX + 1);
+    snprintf(mostNegative, sizeof(mostNegative), "%ld", LONG_MIN);
+    mismatches += checkInt(longest, true, LONG_MAX, strlen(longest));
+    mismatches += checkInt(mostNegative, true, LONG_MIN, strlen(mostNegative));
+    mismatches += checkInt(tooBig, false, 0, 0);
+    mismatches += checkInt("-99999999999999999999", false, 0, 0);
+    mismatches += checkInt("", false, 0, 0);
+    mismatches += checkInt("-", false, 0, 0);
+    mismatches += checkInt("+", false, 0, 0);
+    mismatches += checkInt(".", false, 0, 0);
+    mismatches += checkInt("e5", false, 0, 0);
+    mismatches += checkInt("abc", false, 0, 0);
+    mismatches += checkInt(" -42x", true, -42, 4);
+
+    //Partial numbers, where the exponent is left unread as strtod does.
+    mismatches += checkFloat("", false);
+    mismatches += checkFloat("-", false);
+    mismatches += checkFloat(".", false);
+    mismatches += checkFloat("-.e5", false);
+    mismatches += checkFloat("1e", true);
+    mismatches += checkFloat("1e+", true);
+    mismatches += checkFloat("1e-", true);
+    mismatches += checkFloat("2.5E", true);
+
+    //Exponents past the exact powers of ten, and out of range.
+    const char *scaled[] = { "1e23", "1.5e-23", "-8424.914e30", "123456789e-40",
+        "1e308", "2.2250738585072014e-308", "12345678901234567890123e5",
+        "0.000000000000000000000000001", "1e-400" };
+    for(int i = 0; i < (int)(sizeof(scaled)/sizeof(scaled[0])); i++)
+        mismatches += checkFloat(scaled[i], true);
+    mismatches += checkFloat("1e309", false);
+    mismatches += checkFloat("-1e400", false);
+    mismatches += checkFloat("1e99999", false);
+
+    //Formatting, including where the stream switches to an exponent.
+    const float formatted[] = { 0.0f, 1.0f, -0.5f, 8424.914f, 1420.125f,
+        999999.0f, 999999.6f, 1234567.0f, -1e10f, 0.0001f, 0.00012345f,
+        0.00001f, 3e-20f, 1e30f };
+    for(int i = 0; i < (int)(sizeof(formatted)/sizeof(formatted[0])); i++)
+    {
+        if(Utils::ftos(formatted[i]) == streamFtos(formatted[i])) continue;
+        printf("ftos(%g) gives \"%s\", the stream \"%s\"\n", formatted[i],
+                Utils::ftos(formatted[i]).c_str(), streamFtos(formatted[i]).c_str());
+        mismatches++;
+    }
+    printf("numbers parsed or formatted wrongly: %d\n", mismatches);
+
+    //Parse a sky frequency.
+    double sum = 0.0;
+    double start = now();
+    for(int i = 0; i < BENCH_COUNT; i++)
+        sum += streamStof(freqs[i % freqs.size()]);
+    double streamParse = now() - start;
+
+    start = now();
+    for(int i = 0; i < BENCH_COUNT; i++)
+    {
+        const string &freq = freqs[i % freqs.size()];
+        double number = 0.0;
+        Utils::parseFloat(freq.data(), freq.data() + freq.size(), number);
+        sum += (float)number;
+    }
+    double fastParse = now() - start;
+
+    //Compose a summary count.
+    size_t length = 0;
+    start = now();
+    for(int i = 0; i < BENCH_COUNT; i++)
+    {
+        string line = "Total Dxs=" + streamItos(i % 500);
+        length += line.size();
+    }
+    double streamFormat = now() - start;
+
+    string line;
+    start = now();
+    for(int i = 0; i < BENCH_COUNT; i++)
+    {
+        line.assign("Total Dxs=");
+        Utils::appendInt(line, i % 500);
+        length += line.size();
+    }
+    double fastFormat = now() - start;
+
+    printf("parse sky freq:   stringstream %6.1f ns, parseFloat %6.1f ns\n",
+            streamParse * 1e9 / BENCH_COUNT, fastParse * 1e9 / BENCH_COUNT);
+    printf("compose summary:  stringstream %6.1f ns, appendInt  %6.1f ns\n",
+            streamFormat * 1e9 / BENCH_COUNT, fastFormat * 1e9 / BENCH_COUNT);
+    printf("(checksums %.0f %lu)\n", sum, (unsigned long)length);
+
+    return (mismatches == 0) ? 0 : 1;
+}